@@ -0,0 +1,133 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "admission.hpp"
+#include "protocol.hpp"
+#include "sample_format.hpp"
+
+#include <stdexcept>
+
+namespace admission {
+
+namespace {
+
+    // v4 mapped v6 addresses match the v4 rules
+    asio::ip::address normalize(const asio::ip::address& address)
+    {
+        if (address.is_v6() && address.to_v6().is_v4_mapped()) {
+            return asio::ip::make_address_v4(asio::ip::v4_mapped, address.to_v6());
+        }
+        return address;
+    }
+
+    template <typename Bytes>
+    bool match_prefix(const Bytes& a, const Bytes& b, int prefix_length)
+    {
+        for (size_t i = 0; i < a.size() && prefix_length > 0; ++i, prefix_length -= 8) {
+            uint8_t mask = prefix_length >= 8 ? 0xff : (uint8_t)(0xff << (8 - prefix_length));
+            if ((a[i] & mask) != (b[i] & mask)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+rule_t parse_rule(const std::string& s)
+{
+    auto eq = s.find('=');
+    if (eq == std::string::npos) {
+        throw std::invalid_argument("priority rule without class: " + s);
+    }
+
+    rule_t rule {};
+    auto name = s.substr(eq + 1);
+    if (name == "low") {
+        rule.priority = priority_t::priority_low;
+    } else if (name == "normal") {
+        rule.priority = priority_t::priority_normal;
+    } else if (name == "high") {
+        rule.priority = priority_t::priority_high;
+    } else {
+        throw std::invalid_argument("unknown priority class: " + name);
+    }
+
+    auto network = s.substr(0, eq);
+    auto slash = network.find('/');
+    asio::error_code ec;
+    rule.network = normalize(asio::ip::make_address(network.substr(0, slash), ec));
+    if (ec) {
+        throw std::invalid_argument("bad priority rule address: " + network);
+    }
+    const int max_length = rule.network.is_v4() ? 32 : 128;
+    rule.prefix_length = slash == std::string::npos ? max_length : std::stoi(network.substr(slash + 1));
+    if (rule.prefix_length < 0 || rule.prefix_length > max_length) {
+        throw std::invalid_argument("bad priority rule prefix length: " + network);
+    }
+    return rule;
+}
+
+priority_t classify(const std::vector<rule_t>& rule_list, const asio::ip::address& address)
+{
+    auto addr = normalize(address);
+    auto priority = priority_t::priority_normal;
+    int best_length = -1;
+    for (auto& rule : rule_list) {
+        if (rule.network.is_v4() != addr.is_v4() || rule.prefix_length <= best_length) {
+            continue;
+        }
+        bool match = addr.is_v4()
+            ? match_prefix(rule.network.to_v4().to_bytes(), addr.to_v4().to_bytes(), rule.prefix_length)
+            : match_prefix(rule.network.to_v6().to_bytes(), addr.to_v6().to_bytes(), rule.prefix_length);
+        if (match) {
+            priority = rule.priority;
+            best_length = rule.prefix_length;
+        }
+    }
+    return priority;
+}
+
+const char* to_string(priority_t priority)
+{
+    switch (priority) {
+    case priority_t::priority_low:
+        return "low";
+    case priority_t::priority_high:
+        return "high";
+    default:
+        return "normal";
+    }
+}
+
+uint64_t stream_bitrate(const output_profile_t::AudioFormat& capture_format, const output_profile_t& profile)
+{
+    const auto format = profile.make_format(capture_format);
+    const uint64_t block_align = sample_format::bytes_per_sample(format.encoding()) * format.channels();
+    const uint64_t pcm_rate = block_align * format.sample_rate();
+    const uint64_t header_size = (profile.packet_header ? sizeof(protocol::packet_header_t) : 0)
+        + (profile.presentation_time ? sizeof(uint64_t) : 0);
+    if (pcm_rate == 0 || profile.max_payload_size <= header_size + block_align) {
+        return 0;
+    }
+
+    uint64_t seg_size = profile.max_payload_size - header_size;
+    seg_size -= seg_size % block_align;
+    const uint64_t datagram_rate = (pcm_rate + seg_size - 1) / seg_size;
+    return (pcm_rate + datagram_rate * (header_size + 20 + 8)) * 8;
+}
+
+} // namespace admission
@@ -0,0 +1,57 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ADMISSION_HPP
+#define ADMISSION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pre_asio.hpp"
+#include <asio.hpp>
+
+#include "output_profile.hpp"
+
+// Priority classes and stream costs used by the admission control.
+namespace admission {
+
+enum class priority_t : uint8_t {
+    priority_low = 0,
+    priority_normal = 1,
+    priority_high = 2,
+};
+
+struct rule_t {
+    asio::ip::address network;
+    int prefix_length;
+    priority_t priority;
+};
+
+// "<address>[/<prefix length>]=<low|normal|high>", throw std::invalid_argument
+rule_t parse_rule(const std::string& s);
+
+// the longest matching prefix wins, normal if none matches
+priority_t classify(const std::vector<rule_t>& rule_list, const asio::ip::address& address);
+
+const char* to_string(priority_t priority);
+
+// bits per second on the wire, udp and ip headers included
+uint64_t stream_bitrate(const output_profile_t::AudioFormat& capture_format, const output_profile_t& profile);
+
+} // namespace admission
+
+#endif // !ADMISSION_HPP
@@ -1,27 +1,48 @@
-#include "audio_manager.hpp"
-
-audio_manager::audio_manager()
-{
-    _format = std::make_unique<AudioFormat>();
-}
-
-audio_manager::~audio_manager() = default;
-
-void audio_manager::start_loopback_recording(std::shared_ptr<network_manager> network_manager, const capture_config& config)
-{
-    _stopped = false;
-    _record_thread = std::thread([network_manager = network_manager, config = config, self = shared_from_this()] {
-        self->do_loopback_recording(network_manager, config);
-    });
-}
-
-void audio_manager::stop()
-{
-    _stopped = true;
-    _record_thread.join();
-}
-
-std::string audio_manager::get_format_binary()
-{
-    return _format->SerializeAsString();
-}
\ No newline at end of file
+#include "audio_manager.hpp"
+#include "network_manager.hpp"
+
+audio_manager::audio_manager() = default;
+
+audio_manager::~audio_manager() = default;
+
+void audio_manager::start_loopback_recording(std::shared_ptr<network_manager> network_manager, const capture_config& config)
+{
+    _stopped = false;
+    _record_thread = std::thread([network_manager = network_manager, config = config, self = shared_from_this()] {
+        realtime::apply("capture", config.thread);
+        realtime::prefault();
+        self->do_loopback_recording(network_manager, config);
+    });
+}
+
+void audio_manager::stop()
+{
+    _stopped = true;
+    apply_active();
+    _record_thread.join();
+}
+
+void audio_manager::set_active(bool active)
+{
+    if (_active.exchange(active) == active) {
+        return;
+    }
+    apply_active();
+}
+
+void audio_manager::set_format(const AudioFormat& format, const std::shared_ptr<network_manager>& network_manager)
+{
+    {
+        std::lock_guard lock(_format_mutex);
+        auto version = _format.version() + 1;
+        _format = format;
+        _format.set_version(version);
+    }
+    network_manager->notify_format_changed();
+}
+
+audio_manager::AudioFormat audio_manager::get_format()
+{
+    std::lock_guard lock(_format_mutex);
+    return _format;
+}
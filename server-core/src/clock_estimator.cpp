@@ -0,0 +1,47 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "clock_estimator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+bool clock_estimator::update(int64_t t1, int64_t t2, int64_t t3, int64_t t4)
+{
+    const int64_t rtt = (t4 - t1) - (t3 - t2);
+    if (t4 < t1 || t3 < t2 || rtt < 0) {
+        return false;
+    }
+    const auto rtt_us = (uint32_t)std::min<int64_t>(rtt, std::numeric_limits<uint32_t>::max());
+
+    if (_count == 0) {
+        _srtt_us = rtt_us;
+        _rttvar_us = rtt_us / 2;
+    } else {
+        _rttvar_us = (uint32_t)(((uint64_t)_rttvar_us * 3 + std::abs((int64_t)_srtt_us - rtt_us)) / 4);
+        _srtt_us = (uint32_t)(((uint64_t)_srtt_us * 7 + rtt_us) / 8);
+    }
+
+    // the lowest round trip time has the least queueing, so the most symmetric path
+    _samples[_count++ % _samples.size()] = { rtt_us, ((t2 - t1) + (t3 - t4)) / 2 };
+    const auto end = _samples.begin() + std::min<uint64_t>(_count, _samples.size());
+    _offset_us = std::min_element(_samples.begin(), end, [](auto& a, auto& b) { return a.rtt_us < b.rtt_us; })->offset_us;
+
+    const auto forward_us = (uint32_t)std::clamp<int64_t>(t2 - t1 - _offset_us, 0, rtt_us);
+    _one_way_delay_us = _count == 1 ? forward_us : (uint32_t)(((uint64_t)_one_way_delay_us * 7 + forward_us) / 8);
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef CLOCK_ESTIMATOR_HPP
+#define CLOCK_ESTIMATOR_HPP
+
+#include <array>
+#include <cstdint>
+
+// NTP style estimation of the path and the clock of one client.
+// A probe is stamped by the server (t1), received (t2) and echoed (t3) by the client, then received back (t4).
+// t1 and t4 are on the server clock, t2 and t3 on the client clock, all in us.
+class clock_estimator {
+public:
+    // return false for an impossible sample, which is ignored
+    bool update(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+    bool measured() const { return _count != 0; }
+
+    // rfc 6298 smoothing, 0 until measured
+    uint32_t srtt_us() const { return _srtt_us; }
+    uint32_t rttvar_us() const { return _rttvar_us; }
+
+    // client clock minus server clock, taken from the sample of the lowest round trip time among the last ones
+    int64_t offset_us() const { return _offset_us; }
+
+    // smoothed server to client delay, above the half round trip time when the queues build up on the way down
+    uint32_t one_way_delay_us() const { return _one_way_delay_us; }
+
+private:
+    struct sample_t {
+        uint32_t rtt_us;
+        int64_t offset_us;
+    };
+
+    std::array<sample_t, 8> _samples {};
+    uint64_t _count = 0;
+    uint32_t _srtt_us = 0;
+    uint32_t _rttvar_us = 0;
+    int64_t _offset_us = 0;
+    uint32_t _one_way_delay_us = 0;
+};
+
+#endif // !CLOCK_ESTIMATOR_HPP
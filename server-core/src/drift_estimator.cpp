@@ -0,0 +1,75 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "drift_estimator.hpp"
+
+#include <cmath>
+#include <numbers>
+
+void drift_estimator::reset(int sample_rate)
+{
+    _sample_rate = sample_rate;
+    _started = false;
+    _nominal_frame_ns = sample_rate > 0 ? 1e9 / sample_rate : 0;
+    _frame_ns = _nominal_frame_ns;
+}
+
+void drift_estimator::update(const clock_reading_t& reading)
+{
+    if (_sample_rate <= 0 || reading.time == std::chrono::steady_clock::time_point {}) {
+        return;
+    }
+    const double time_ns = (double)reading.time.time_since_epoch().count();
+    if (_started && reading.position > _position) {
+        const auto frames = reading.position - _position;
+        const double predicted_ns = _time_ns + frames * _frame_ns;
+        const double error_ns = time_ns - predicted_ns;
+        if (std::abs(error_ns) < std::chrono::duration<double, std::nano>(_max_error).count()) {
+            // Fons Adriaensen's dll, scaled by the frames of this update
+            const double omega = 2 * std::numbers::pi * _bandwidth * frames / _sample_rate;
+            _time_ns = predicted_ns + std::numbers::sqrt2 * omega * error_ns;
+            _frame_ns += omega * omega * error_ns / frames;
+            _position = reading.position;
+            _last = reading.time;
+            return;
+        }
+    } else if (_started && reading.position == _position) {
+        return;
+    }
+
+    _started = true;
+    _position = reading.position;
+    _time_ns = time_ns;
+    _frame_ns = _nominal_frame_ns;
+    _start = reading.time;
+    _last = reading.time;
+}
+
+bool drift_estimator::locked() const
+{
+    return _started && _last - _start >= _settle_time;
+}
+
+double drift_estimator::ratio() const
+{
+    return locked() ? _nominal_frame_ns / _frame_ns : 1;
+}
+
+std::chrono::steady_clock::time_point drift_estimator::time_of(uint64_t position) const
+{
+    const double time_ns = _time_ns + ((double)position - (double)_position) * _frame_ns;
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds((int64_t)time_ns));
+}
@@ -0,0 +1,61 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef DRIFT_ESTIMATOR_HPP
+#define DRIFT_ESTIMATOR_HPP
+
+#include <chrono>
+#include <cstdint>
+
+// A reading of the capture clock: the device had produced `position` frames at `time` on the steady clock.
+// Linux takes it from pw_stream_get_time(), Windows from IAudioCaptureClient::GetBuffer().
+struct clock_reading_t {
+    uint64_t position = 0;
+    std::chrono::steady_clock::time_point time; // empty if the backend gave none
+};
+
+// Rate of the capture clock against the steady clock.
+// A second order delay locked loop, the capture timing jitter is averaged out over about 1 / bandwidth.
+class drift_estimator {
+public:
+    void reset(int sample_rate);
+    void update(const clock_reading_t& reading);
+
+    // the loop has settled
+    bool locked() const;
+
+    // capture frames per steady clock second over the nominal sample rate, 1 until locked
+    double ratio() const;
+
+    // steady clock time of `position`, on the filtered line
+    std::chrono::steady_clock::time_point time_of(uint64_t position) const;
+
+private:
+    constexpr static double _bandwidth = 0.05; // Hz
+    constexpr static auto _settle_time = std::chrono::seconds(20);
+    constexpr static auto _max_error = std::chrono::milliseconds(50); // more is a discontinuity, the loop restarts
+
+    int _sample_rate = 0;
+    bool _started = false;
+    uint64_t _position = 0;
+    double _time_ns = 0;     // filtered time of _position
+    double _frame_ns = 0;    // filtered frame period
+    double _nominal_frame_ns = 0;
+    std::chrono::steady_clock::time_point _start;
+    std::chrono::steady_clock::time_point _last;
+};
+
+#endif // !DRIFT_ESTIMATOR_HPP
@@ -0,0 +1,105 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "event_loop.hpp"
+#include "rt_log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace event_loop {
+
+void run(asio::io_context& ioc, std::chrono::microseconds spin)
+{
+    if (spin.count() <= 0) {
+        ioc.run();
+        return;
+    }
+
+    auto idle_since = std::chrono::steady_clock::now();
+    while (!ioc.stopped()) {
+        if (ioc.poll()) {
+            idle_since = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (std::chrono::steady_clock::now() - idle_since < spin) {
+            continue;
+        }
+        // nothing for a whole budget, sleep until the next handler
+        if (!ioc.run_one()) {
+            return;
+        }
+        idle_since = std::chrono::steady_clock::now();
+    }
+}
+
+bool set_busy_poll(asio::ip::udp::socket::native_handle_type socket, std::chrono::microseconds budget)
+{
+#ifdef SO_BUSY_POLL
+    int value = (int)budget.count();
+    if (::setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value))) {
+        // raising it above net.core.busy_read needs CAP_NET_ADMIN
+        rt_log::warn("{} {}", __func__, std::strerror(errno));
+        return false;
+    }
+    rt_log::info("busy poll {}us", budget.count());
+    return true;
+#else
+    rt_log::warn("busy poll is not supported on this platform");
+    return false;
+#endif // SO_BUSY_POLL
+}
+
+jitter_stats_t measure_jitter(std::chrono::microseconds period, size_t samples, std::chrono::microseconds spin)
+{
+    using steady_timer = asio::as_tuple_t<asio::use_awaitable_t<>>::as_default_on_t<asio::steady_timer>;
+
+    asio::io_context ioc;
+    std::vector<std::chrono::nanoseconds> lateness;
+    lateness.reserve(samples);
+
+    asio::co_spawn(ioc, [&]() -> asio::awaitable<void> {
+        steady_timer timer(ioc);
+        auto deadline = std::chrono::steady_clock::now();
+        while (lateness.size() < samples) {
+            deadline += period;
+            timer.expires_at(deadline);
+            auto [ec] = co_await timer.async_wait();
+            if (ec) {
+                co_return;
+            }
+            lateness.push_back(std::chrono::steady_clock::now() - deadline);
+        }
+    }, asio::detached);
+    run(ioc, spin);
+
+    jitter_stats_t stats {};
+    stats.samples = lateness.size();
+    if (lateness.empty()) {
+        return stats;
+    }
+    std::ranges::sort(lateness);
+    auto percentile = [&](double p) { return lateness[std::min(lateness.size() - 1, (size_t)(p * lateness.size()))]; };
+    stats.p50 = percentile(0.5);
+    stats.p99 = percentile(0.99);
+    stats.p999 = percentile(0.999);
+    stats.max = lateness.back();
+    return stats;
+}
+
+} // namespace event_loop
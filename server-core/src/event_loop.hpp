@@ -0,0 +1,50 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <chrono>
+#include <cstddef>
+
+#include "pre_asio.hpp"
+#include <asio.hpp>
+
+// Drivers of the network thread io_context.
+namespace event_loop {
+
+// run until the io_context is stopped or out of work.
+// With a spin budget, the loop polls without sleeping and only blocks after `spin` without any handler,
+// so a handler that becomes ready is run without the wake-up latency of the kernel. It keeps a core busy.
+void run(asio::io_context& ioc, std::chrono::microseconds spin);
+
+// set SO_BUSY_POLL, the kernel then polls the device queue for `budget` instead of waiting for an interrupt
+bool set_busy_poll(asio::ip::udp::socket::native_handle_type socket, std::chrono::microseconds budget);
+
+struct jitter_stats_t {
+    size_t samples;
+    std::chrono::nanoseconds p50;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds p999;
+    std::chrono::nanoseconds max;
+};
+
+// lateness of a periodic timer driven by run(), on the calling thread
+jitter_stats_t measure_jitter(std::chrono::microseconds period, size_t samples, std::chrono::microseconds spin);
+
+} // namespace event_loop
+
+#endif // !EVENT_LOOP_HPP
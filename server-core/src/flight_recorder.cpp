@@ -0,0 +1,228 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "flight_recorder.hpp"
+#include "rt_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace flight_recorder {
+
+namespace {
+
+    // file layout, little endian: file_header_t then event_count file_event_t
+    struct file_header_t {
+        char magic[4];
+        uint32_t version;
+        uint64_t event_count;
+        uint64_t dump_time_ns;  // steady clock, the time base of the events
+        uint32_t reason;
+        uint32_t reserved;
+    };
+
+    struct file_event_t {
+        uint64_t time_ns;
+        uint32_t type;
+        uint32_t a;
+        uint64_t b;
+    };
+
+    struct slot_t {
+        std::atomic<uint64_t> sequence { 0 }; // 2 * index + 1 while written, 2 * index + 2 once done
+        std::atomic<uint64_t> time_ns;
+        std::atomic<uint32_t> type;
+        std::atomic<uint32_t> a;
+        std::atomic<uint64_t> b;
+    };
+
+    constexpr std::array<const char*, 4> reason_names { "signal", "send-gap", "overrun", "xrun" };
+    constexpr auto dump_delay = std::chrono::milliseconds(500);
+    constexpr auto min_dump_interval = std::chrono::milliseconds(5000);
+
+    std::atomic_bool g_enabled;
+    std::unique_ptr<slot_t[]> g_slots;
+    size_t g_mask = 0;
+    std::atomic<uint64_t> g_head;
+    std::string g_directory;
+
+    std::atomic<uint32_t> g_trigger; // 0 or reason + 1
+    std::atomic_bool g_stopped;
+    std::thread g_dump_thread;
+
+    uint64_t now_ns()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::vector<file_event_t> snapshot()
+    {
+        const uint64_t head = g_head.load(std::memory_order_acquire);
+        const uint64_t capacity = g_mask + 1;
+        std::vector<file_event_t> events;
+        events.reserve((size_t)std::min(head, capacity));
+        for (uint64_t index = head > capacity ? head - capacity : 0; index < head; ++index) {
+            auto& slot = g_slots[index & g_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != 2 * index + 2) {
+                continue;
+            }
+            file_event_t event {
+                .time_ns = slot.time_ns.load(std::memory_order_relaxed),
+                .type = slot.type.load(std::memory_order_relaxed),
+                .a = slot.a.load(std::memory_order_relaxed),
+                .b = slot.b.load(std::memory_order_relaxed),
+            };
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != 2 * index + 2) {
+                continue; // overwritten while read
+            }
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    void dump(reason_t reason)
+    {
+        auto events = snapshot();
+        file_header_t header {
+            .magic = { 'A', 'S', 'F', 'R' },
+            .version = 1,
+            .event_count = events.size(),
+            .dump_time_ns = now_ns(),
+            .reason = reason,
+            .reserved = 0,
+        };
+
+        auto name = fmt::format("flight-{}-{}.bin", (int64_t)std::time(nullptr), reason_names[reason]);
+        auto path = std::filesystem::path(g_directory) / name;
+        std::ofstream file(path, std::ios::binary);
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)events.data(), events.size() * sizeof(file_event_t));
+        if (!file) {
+            rt_log::error("flight recorder can't write {}", path.string());
+            return;
+        }
+        rt_log::warn("flight recorder dump {} reason:{} events:{}", path.string(), reason_names[reason], events.size());
+    }
+
+    // return false if stopped meanwhile
+    bool sleep_for(std::chrono::milliseconds duration)
+    {
+        for (auto end = std::chrono::steady_clock::now() + duration; std::chrono::steady_clock::now() < end;) {
+            if (g_stopped) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        return !g_stopped;
+    }
+
+    void dump_loop()
+    {
+        while (true) {
+            g_trigger.wait(0);
+            // read before the delay, stop() overwrites it meanwhile, after setting g_stopped
+            const uint32_t trigger = g_trigger.load();
+            if (!sleep_for(dump_delay)) {
+                return;
+            }
+            dump((reason_t)(trigger - 1));
+            // the triggers in the meantime are covered by this dump
+            if (!sleep_for(min_dump_interval - dump_delay)) {
+                return;
+            }
+            g_trigger = 0;
+            if (g_stopped) {
+                return;
+            }
+        }
+    }
+
+} // namespace
+
+void start(const std::string& directory, size_t capacity)
+{
+    if (g_enabled) {
+        return;
+    }
+    capacity = std::bit_ceil(std::max<size_t>(capacity, 2));
+    if (g_mask + 1 != capacity) {
+        g_slots = std::make_unique<slot_t[]>(capacity);
+        g_mask = capacity - 1;
+    }
+    g_directory = directory;
+    g_stopped = false;
+    g_trigger = 0;
+    g_dump_thread = std::thread(dump_loop);
+    g_enabled = true;
+    rt_log::info("flight recorder {} events to {}", capacity, directory);
+}
+
+void stop()
+{
+    if (!g_enabled) {
+        return;
+    }
+    g_enabled = false;
+    g_stopped = true;
+    g_trigger = UINT32_MAX;
+    g_trigger.notify_one();
+    g_dump_thread.join();
+}
+
+bool enabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void record(event_t type, uint32_t a, uint64_t b)
+{
+    if (!g_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const uint64_t index = g_head.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = g_slots[index & g_mask];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time_ns.store(now_ns(), std::memory_order_relaxed);
+    slot.type.store(type, std::memory_order_relaxed);
+    slot.a.store(a, std::memory_order_relaxed);
+    slot.b.store(b, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void trigger(reason_t reason)
+{
+    if (!g_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    record(event_trigger, reason);
+    uint32_t idle = 0;
+    if (g_trigger.compare_exchange_strong(idle, reason + 1)) {
+        g_trigger.notify_one();
+    }
+}
+
+} // namespace flight_recorder
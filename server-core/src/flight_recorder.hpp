@@ -0,0 +1,63 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+#include <cstdint>
+#include <string>
+
+// Ring of the last pipeline events, dumped to a file when something goes wrong.
+// Any thread records with a fetch_add and a few relaxed stores, a slot being overwritten is detected by its
+// sequence and skipped by the dump. The dump is written by a background thread, so a trigger from the capture
+// callback costs one atomic store and a futex wake. Decode a dump with tools/flight_recorder.py.
+namespace flight_recorder {
+
+enum event_t : uint32_t {
+    event_none = 0,
+    event_capture = 1,          // a: bytes, b: frames
+    event_fanout = 2,           // a: packets, b: duration ns
+    event_send = 3,             // a: peer id, 0 for multicast, b: bytes
+    event_send_error = 4,       // a: peer id, b: error value
+    event_drop = 5,             // a: peer id, b: in-flight datagrams
+    event_format_changed = 6,   // a: format version, b: sample rate
+    event_timeout = 7,          // a: peer id
+    event_xrun = 8,
+    event_send_gap = 9,         // a: gap us, b: quantum us
+    event_trigger = 10,         // a: reason_t
+};
+
+enum reason_t : uint32_t {
+    reason_signal = 0,
+    reason_send_gap = 1,    // no fan-out for 2 quanta
+    reason_overrun = 2,     // a datagram was dropped at the in-flight limit
+    reason_xrun = 3,        // the capture lost a buffer
+};
+
+// record into a ring of `capacity` events, rounded up to a power of two, and dump to `directory`
+void start(const std::string& directory, size_t capacity = size_t(1) << 16);
+void stop();
+bool enabled();
+
+void record(event_t type, uint32_t a = 0, uint64_t b = 0);
+
+// dump the ring shortly after, so the events following the anomaly are in too.
+// triggers closer than a few seconds share the same dump.
+void trigger(reason_t reason);
+
+} // namespace flight_recorder
+
+#endif // !FLIGHT_RECORDER_HPP
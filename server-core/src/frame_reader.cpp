@@ -0,0 +1,86 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "frame_reader.hpp"
+#include "protocol.hpp"
+
+#include <cstring>
+
+frame_reader::frame_reader(size_t capacity)
+    : _buffer(capacity)
+{
+}
+
+asio::mutable_buffer frame_reader::prepare()
+{
+    // move the partial frame to the front
+    if (_begin == _end) {
+        _begin = _end = 0;
+    } else if (_begin > 0) {
+        std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+        _end -= _begin;
+        _begin = 0;
+    }
+
+    if (_end == _buffer.size()) {
+        _buffer.resize(_buffer.size() * 2);
+    }
+    return asio::buffer(_buffer.data() + _end, _buffer.size() - _end);
+}
+
+void frame_reader::commit(size_t size)
+{
+    _end += size;
+}
+
+auto frame_reader::next(frame_t& frame) -> result_t
+{
+    const size_t available = _end - _begin;
+    const char* data = _buffer.data() + _begin;
+
+    uint32_t cmd = 0;
+    if (available < sizeof(cmd)) {
+        return result_t::need_more;
+    }
+    std::memcpy(&cmd, data, sizeof(cmd));
+
+    if (!protocol::is_framed(cmd)) {
+        frame = { cmd, {} };
+        _begin += sizeof(cmd);
+        return result_t::ok;
+    }
+
+    uint32_t size = 0;
+    if (available < sizeof(cmd) + sizeof(size)) {
+        return result_t::need_more;
+    }
+    std::memcpy(&size, data + sizeof(cmd), sizeof(size));
+    if (size > protocol::max_payload_size) {
+        return result_t::error;
+    }
+
+    const size_t frame_size = sizeof(cmd) + sizeof(size) + size;
+    if (available < frame_size) {
+        if (_buffer.size() < frame_size) {
+            _buffer.resize(frame_size);
+        }
+        return result_t::need_more;
+    }
+
+    frame = { cmd, { data + sizeof(cmd) + sizeof(size), size } };
+    _begin += frame_size;
+    return result_t::ok;
+}
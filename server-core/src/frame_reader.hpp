@@ -0,0 +1,55 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef FRAME_READER_HPP
+#define FRAME_READER_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "pre_asio.hpp"
+#include <asio/buffer.hpp>
+
+// Per-connection receive buffer of the control channel.
+// Read whatever is available into prepare(), commit() it, then call next() until it
+// stops returning `ok`, so pipelined commands are handled in one wakeup.
+class frame_reader {
+public:
+    enum class result_t {
+        ok,
+        need_more,
+        error,
+    };
+
+    struct frame_t {
+        uint32_t cmd = 0;
+        std::string_view payload; // valid until the next prepare()
+    };
+
+    explicit frame_reader(size_t capacity = 4096);
+
+    asio::mutable_buffer prepare();
+    void commit(size_t size);
+    result_t next(frame_t& frame);
+
+private:
+    std::vector<char> _buffer;
+    size_t _begin = 0;
+    size_t _end = 0;
+};
+
+#endif // !FRAME_READER_HPP
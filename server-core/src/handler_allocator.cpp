@@ -0,0 +1,236 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "handler_allocator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <vector>
+
+namespace handler_memory {
+
+namespace {
+
+    constexpr size_t min_class_size = 64;
+    constexpr size_t class_count = 9; // 64 B .. 16 KiB, a capture quantum fits
+    constexpr size_t max_cached_blocks = 256; // per class and thread, as many more freed by the other threads
+
+    struct cache_t;
+
+    // in front of every block, keeps the payload aligned as operator new does
+    struct alignas(std::max_align_t) header_t {
+        cache_t* owner; // nullptr for the blocks above the largest class
+        uint32_t size_class;
+        header_t* next; // free list link
+    };
+
+    struct cache_t {
+        std::array<header_t*, class_count> free_list {};
+        std::array<size_t, class_count> free_count {};
+        std::array<std::atomic<header_t*>, class_count> remote_list {};
+        std::array<std::atomic<size_t>, class_count> remote_count {};
+        std::atomic<size_t> refs = 1; // the blocks it took from the heap, plus one for its thread
+    };
+
+    // ends the remote lists of a cache whose thread has exited
+    header_t g_closed;
+
+    std::atomic<uint64_t> g_allocations;
+    std::atomic<uint64_t> g_heap_allocations;
+    std::atomic<uint64_t> g_remote_frees;
+    std::atomic<uint64_t> g_in_use;
+
+    void release(cache_t* cache, size_t count = 1)
+    {
+        if (cache->refs.fetch_sub(count, std::memory_order_acq_rel) == count) {
+            delete cache;
+        }
+    }
+
+    void free_block(header_t* header)
+    {
+        auto owner = header->owner;
+        ::operator delete(header);
+        release(owner);
+    }
+
+    size_t free_chain(header_t* header)
+    {
+        size_t count = 0;
+        while (header) {
+            auto next = header->next;
+            ::operator delete(header);
+            header = next;
+            ++count;
+        }
+        return count;
+    }
+
+    // the blocks still in use keep the cache alive, they go to the heap when freed
+    void close(cache_t* cache)
+    {
+        size_t count = 0;
+        for (size_t index = 0; index < class_count; ++index) {
+            count += free_chain(cache->free_list[index]);
+            count += free_chain(cache->remote_list[index].exchange(&g_closed, std::memory_order_acquire));
+        }
+        release(cache, count + 1);
+    }
+
+    struct thread_cache_t {
+        cache_t* cache = new cache_t;
+
+        ~thread_cache_t()
+        {
+            close(cache);
+            cache = nullptr;
+        }
+    };
+
+    // nullptr while the thread exits
+    cache_t* local_cache()
+    {
+        thread_local thread_cache_t local;
+        return local.cache;
+    }
+
+    size_t class_index(size_t size)
+    {
+        size = std::max(size, min_class_size);
+        return std::bit_width(size - 1) - std::bit_width(min_class_size - 1);
+    }
+
+    size_t class_size(size_t index)
+    {
+        return min_class_size << index;
+    }
+
+} // namespace
+
+void* allocate(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_in_use.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t index = class_index(size);
+    auto cache = local_cache();
+    if (index >= class_count || !cache) {
+        g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        auto header = (header_t*)::operator new(sizeof(header_t) + size);
+        header->owner = nullptr;
+        return header + 1;
+    }
+
+    auto header = cache->free_list[index];
+    if (!header) {
+        // take back everything the other threads have freed
+        header = cache->remote_list[index].exchange(nullptr, std::memory_order_acquire);
+        cache->free_count[index] = 0;
+        for (auto h = header; h; h = h->next) {
+            ++cache->free_count[index];
+        }
+        cache->remote_count[index].fetch_sub(cache->free_count[index], std::memory_order_relaxed);
+    }
+    if (header) {
+        cache->free_list[index] = header->next;
+        --cache->free_count[index];
+        return header + 1;
+    }
+
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    header = (header_t*)::operator new(sizeof(header_t) + class_size(index));
+    header->owner = cache;
+    header->size_class = (uint32_t)index;
+    cache->refs.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+}
+
+void deallocate(void* p) noexcept
+{
+    if (!p) {
+        return;
+    }
+    g_in_use.fetch_sub(1, std::memory_order_relaxed);
+
+    auto header = (header_t*)p - 1;
+    if (!header->owner) {
+        ::operator delete(header);
+        return;
+    }
+
+    const size_t index = header->size_class;
+    auto cache = local_cache();
+    if (header->owner != cache) {
+        // the block keeps its owner alive until it is freed
+        g_remote_frees.fetch_add(1, std::memory_order_relaxed);
+        auto& count = header->owner->remote_count[index];
+        if (count.fetch_add(1, std::memory_order_relaxed) >= max_cached_blocks) {
+            count.fetch_sub(1, std::memory_order_relaxed);
+            free_block(header);
+            return;
+        }
+
+        // push only, the owner pops the whole list at once so there is no ABA
+        auto& list = header->owner->remote_list[index];
+        header->next = list.load(std::memory_order_relaxed);
+        do {
+            if (header->next == &g_closed) {
+                free_block(header);
+                return;
+            }
+        } while (!list.compare_exchange_weak(header->next, header, std::memory_order_release, std::memory_order_relaxed));
+        return;
+    }
+
+    if (cache->free_count[index] >= max_cached_blocks) {
+        free_block(header);
+        return;
+    }
+    header->next = cache->free_list[index];
+    cache->free_list[index] = header;
+    ++cache->free_count[index];
+}
+
+void prefault(size_t count)
+{
+    count = std::min(count, max_cached_blocks);
+    std::vector<void*> blocks(count);
+    for (size_t index = 0; index < class_count; ++index) {
+        for (auto& block : blocks) {
+            block = allocate(class_size(index));
+            std::memset(block, 0, class_size(index));
+        }
+        for (auto block : blocks) {
+            deallocate(block);
+        }
+    }
+}
+
+stats_t stats()
+{
+    return {
+        .allocations = g_allocations.load(std::memory_order_relaxed),
+        .heap_allocations = g_heap_allocations.load(std::memory_order_relaxed),
+        .remote_frees = g_remote_frees.load(std::memory_order_relaxed),
+        .in_use = g_in_use.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace handler_memory
@@ -0,0 +1,73 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef HANDLER_ALLOCATOR_HPP
+#define HANDLER_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Recycling allocator for the handlers and buffers of the hot path.
+// Blocks are kept by size class in a per-thread cache. A block freed by another thread goes
+// back to the cache of its owner through a lock-free list, so the audio thread -> net thread
+// hand-off recycles too. Only a cache miss or a block above the largest class reaches the heap.
+// A cache gives its free blocks back to the heap when its thread exits, and lives on until the
+// blocks still in use elsewhere are freed.
+namespace handler_memory {
+
+struct stats_t {
+    uint64_t allocations;
+    uint64_t heap_allocations;
+    uint64_t remote_frees; // freed by another thread than the owner
+    uint64_t in_use;
+};
+
+void* allocate(size_t size);
+void deallocate(void* p) noexcept;
+stats_t stats();
+
+// fill the cache of the calling thread with `count` touched blocks of every size class
+void prefault(size_t count);
+
+} // namespace handler_memory
+
+template <typename T>
+class handler_allocator {
+public:
+    using value_type = T;
+
+    handler_allocator() noexcept = default;
+
+    template <typename U>
+    handler_allocator(const handler_allocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return (T*)handler_memory::allocate(n * sizeof(T));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        handler_memory::deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const handler_allocator<U>&) const noexcept { return true; }
+};
+
+#endif // !HANDLER_ALLOCATOR_HPP
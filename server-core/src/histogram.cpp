@@ -0,0 +1,111 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "histogram.hpp"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+histogram::snapshot_t histogram::snapshot() const
+{
+    std::array<uint64_t, bucket_count> buckets;
+    uint64_t count = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+
+    snapshot_t snapshot {};
+    snapshot.count = count;
+    if (count == 0) {
+        return snapshot;
+    }
+    snapshot.min = _min.load(std::memory_order_relaxed);
+    snapshot.max = _max.load(std::memory_order_relaxed);
+    snapshot.mean = (double)_sum.load(std::memory_order_relaxed) / _count.load(std::memory_order_relaxed);
+
+    auto percentile = [&](double p) {
+        const uint64_t rank = std::max<uint64_t>((uint64_t)(p * count + 0.5), 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                // middle of the bucket, within 1.6% of any value in it
+                return std::clamp((bucket_value(i) + bucket_value(i + 1) - 1) / 2, snapshot.min, snapshot.max);
+            }
+        }
+        return snapshot.max;
+    };
+    snapshot.p50 = percentile(0.5);
+    snapshot.p90 = percentile(0.9);
+    snapshot.p99 = percentile(0.99);
+    snapshot.p999 = percentile(0.999);
+    return snapshot;
+}
+
+namespace latency {
+
+namespace {
+
+    struct latency_info_t {
+        const char* name;
+        const char* help;
+    };
+
+    constexpr std::array<latency_info_t, latency_count> latency_info { {
+        { "capture", "Capture callback duration." },
+        { "post", "Capture callback to the handler running on the network thread." },
+        { "fanout", "Conversion, segmentation and sends of one captured quantum." },
+        { "send", "UDP send to its completion." },
+        { "wire", "UDP send call to the wire, from the kernel transmit timestamps." },
+    } };
+
+    std::array<histogram, latency_count> g_histograms;
+
+} // namespace
+
+histogram& get(latency_t latency)
+{
+    return g_histograms[latency];
+}
+
+std::string report()
+{
+    std::string out;
+    for (size_t i = 0; i < latency_count; ++i) {
+        auto s = g_histograms[i].snapshot();
+        fmt::format_to(std::back_inserter(out), "{}{:<8} count:{} min:{}ns p50:{}ns p90:{}ns p99:{}ns p99.9:{}ns max:{}ns mean:{:.0f}ns",
+            i ? "\n" : "", latency_info[i].name, s.count, s.min, s.p50, s.p90, s.p99, s.p999, s.max, s.mean);
+    }
+    return out;
+}
+
+void append_metrics(std::string& out)
+{
+    for (size_t i = 0; i < latency_count; ++i) {
+        auto s = g_histograms[i].snapshot();
+        auto name = fmt::format("audio_share_{}_latency_seconds", latency_info[i].name);
+        fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} summary\n", name, latency_info[i].help, name);
+        const std::pair<const char*, uint64_t> quantiles[] = { { "0.5", s.p50 }, { "0.9", s.p90 }, { "0.99", s.p99 }, { "0.999", s.p999 } };
+        for (auto& [quantile, value] : quantiles) {
+            fmt::format_to(std::back_inserter(out), "{}{{quantile=\"{}\"}} {}\n", name, quantile, value / 1e9);
+        }
+        fmt::format_to(std::back_inserter(out), "{}_sum {}\n{}_count {}\n", name, s.mean * s.count / 1e9, name, s.count);
+    }
+}
+
+} // namespace latency
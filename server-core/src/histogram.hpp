@@ -0,0 +1,131 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// HDR style latency histogram.
+// Values are bucketed by their power of two, then linearly by 32 sub buckets, so any value is kept within 3%
+// from 1ns to 18 minutes. Recording is a few shifts and a relaxed store: one thread records, any thread reads.
+class histogram {
+public:
+    static constexpr int sub_bits = 5;
+    static constexpr int max_bits = 40;
+    static constexpr uint64_t sub_count = uint64_t(1) << sub_bits;
+    static constexpr size_t bucket_count = (max_bits - sub_bits + 1) * sub_count;
+
+    struct snapshot_t {
+        uint64_t count;
+        uint64_t min;
+        uint64_t max;
+        double mean;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t p999;
+    };
+
+    void record(uint64_t value)
+    {
+        value = std::min(value, (uint64_t(1) << max_bits) - 1);
+        bump(_buckets[bucket_index(value)], 1);
+        bump(_count, 1);
+        bump(_sum, value);
+        if (value > _max.load(std::memory_order_relaxed)) {
+            _max.store(value, std::memory_order_relaxed);
+        }
+        if (value < _min.load(std::memory_order_relaxed)) {
+            _min.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void record(std::chrono::nanoseconds duration)
+    {
+        record((uint64_t)std::max<int64_t>(duration.count(), 0));
+    }
+
+    // consistent enough for a report, the writer is not stopped
+    snapshot_t snapshot() const;
+
+    static size_t bucket_index(uint64_t value)
+    {
+        if (value < 2 * sub_count) {
+            return (size_t)value;
+        }
+        const int shift = std::bit_width(value) - (sub_bits + 1);
+        return (size_t)((shift + 1) * sub_count + (value >> shift) - sub_count);
+    }
+
+    // the lowest value of the bucket
+    static uint64_t bucket_value(size_t index)
+    {
+        if (index < 2 * sub_count) {
+            return index;
+        }
+        const int shift = (int)(index / sub_count) - 1;
+        return (index % sub_count + sub_count) << shift;
+    }
+
+private:
+    // single writer, no read-modify-write needed
+    static void bump(std::atomic<uint64_t>& value, uint64_t n)
+    {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, bucket_count> _buckets {};
+    std::atomic<uint64_t> _count {};
+    std::atomic<uint64_t> _sum {};
+    std::atomic<uint64_t> _min { UINT64_MAX };
+    std::atomic<uint64_t> _max {};
+};
+
+// The latencies of the audio path, in ns.
+namespace latency {
+
+enum latency_t : uint8_t {
+    latency_capture,    // capture callback duration
+    latency_post,       // capture callback to the posted handler running on the net thread
+    latency_fanout,     // conversion, segmentation and sends of one quantum
+    latency_send,       // udp send to its completion
+    latency_wire,       // udp send call to the wire, from the kernel tx timestamps
+    latency_count,
+};
+
+histogram& get(latency_t latency);
+
+inline void record(latency_t latency, std::chrono::steady_clock::time_point begin)
+{
+    get(latency).record(std::chrono::steady_clock::now() - begin);
+}
+
+// one line per histogram
+std::string report();
+
+// Prometheus summaries, in seconds
+void append_metrics(std::string& out);
+
+} // namespace latency
+
+#endif // !HISTOGRAM_HPP
@@ -1,121 +1,209 @@
-#include "config.h"
-#include "audio_manager.hpp"
-#include "network_manager.hpp"
-
-#include <cxxopts.hpp>
-#include <iostream>
-#include <spdlog/spdlog.h>
-
-using string = std::string;
-
-int main(int argc, char* argv[])
-{
-    auto default_address = network_manager::get_default_address();
-
-    std::string help_string = "Example:\n";
-    help_string += fmt::format("  {} -b\n", AUDIO_SHARE_BIN_NAME);
-    help_string += fmt::format("  {} --bind={}\n", AUDIO_SHARE_BIN_NAME, default_address.empty() ? "192.168.3.2": default_address);
-    help_string += fmt::format("  {} --bind={} --encoding=f32 --channels=2 --sample-rate=48000\n", AUDIO_SHARE_BIN_NAME, default_address.empty() ? "192.168.3.2": default_address);
-    help_string += fmt::format("  {} -l\n", AUDIO_SHARE_BIN_NAME);
-    help_string += fmt::format("  {} --list-encoding\n", AUDIO_SHARE_BIN_NAME);
-    cxxopts::Options options(AUDIO_SHARE_BIN_NAME, help_string);
-
-    // clang-format off
-    options.add_options()
-        ("h,help", "Print usage")
-        ("l,list-endpoint", "List available endpoints")
-        ("b,bind", "The server bind address. If not set, will use default", cxxopts::value<string>()->implicit_value(default_address), "[host][:<port>]")
-        ("e,endpoint", "Specify the endpoint id. If not set or set \"default\", will use default", cxxopts::value<string>()->default_value("default"), "[endpoint]")
-        ("encoding", "Specify the capture encoding. If not set or set \"default\", will use default", cxxopts::value<audio_manager::encoding_t>()->default_value("default"), "[encoding]")
-        ("list-encoding", "List available encoding")
-        ("channels", "Specify the capture channels. If not set or set \"0\", will use default", cxxopts::value<int>()->default_value("0"), "[channels]")
-        ("sample-rate", "Specify the capture sample rate(Hz). If not set or set \"0\", will use default. The common values are 44100, 48000, etc.", cxxopts::value<int>()->default_value("0"), "[sample_rate]")
-        ("V,verbose", "Set log level to \"trace\"")
-        ("v,version", "Show version")
-        ;
-    // clang-format on
-
-    try {
-        auto result = options.parse(argc, argv);
-        if (result.count("help")) {
-            std::cout << options.help();
-            return EXIT_SUCCESS;
-        }
-
-        if (result.count("version")) {
-            fmt::println("{}\nversion: {}\nurl: {}\n", AUDIO_SHARE_BIN_NAME, AUDIO_SHARE_VERSION, AUDIO_SHARE_HOMEPAGE);
-            return EXIT_SUCCESS;
-        }
-
-        if (result.count("verbose")) {
-            spdlog::set_level(spdlog::level::trace);
-        }
-
-        if (result.count("list-endpoint")) {
-            auto audio_manager = std::make_shared<class audio_manager>();
-            auto endpoint_list = audio_manager->get_endpoint_list();
-            auto default_endpoint = audio_manager->get_default_endpoint();
-            auto s = fmt::format("endpoint list:\n");
-            for (auto&& [id, name] : endpoint_list) {
-                s += fmt::format("\t{} id: {:4} name: {}\n", (id == default_endpoint ? '*' : ' '), id, name);
-            }
-            s += fmt::format("total: {}\n", endpoint_list.size());
-            std::cout << s;
-            return EXIT_SUCCESS;
-        }
-
-        if (result.count("list-encoding")) {
-            std::vector<std::pair<string, string>> array = {
-                { "default", "Default encoding" },
-                { "f32", "32 bit floating-point PCM" },
-                { "s8", "8 bit integer PCM" },
-                { "s16", "16 bit integer PCM" },
-                { "s24", "24 bit integer PCM" },
-                { "s32", "32 bit integer PCM" },
-            };
-            fmt::println("encoding list:");
-            for(auto&& e : array) {
-                fmt::println("\t{}\t\t{}", e.first, e.second);
-            }
-            return EXIT_SUCCESS;
-        }
-
-        if (result.count("bind")) {
-            auto s = result["bind"].as<string>();
-            size_t pos = s.find(':');
-            string host = s.substr(0, pos);
-            uint16_t port;
-            if (pos == string::npos) {
-                port = 65530;
-            } else {
-                port = (uint16_t)std::stoi(s.substr(pos + 1));
-            }
-
-            auto audio_manager = std::make_shared<class audio_manager>();
-
-            audio_manager::capture_config capture_config;
-
-            capture_config.endpoint_id = result["endpoint"].as<string>();
-            capture_config.encoding = result["encoding"].as<audio_manager::encoding_t>();
-            capture_config.channels = result["channels"].as<int>();
-            capture_config.sample_rate = result["sample-rate"].as<int>();
-
-            auto network_manager = std::make_shared<class network_manager>(audio_manager);
-
-            network_manager->start_server(host, port, capture_config);
-            network_manager->wait_server();
-
-            return EXIT_SUCCESS;
-        }
-
-        // no arg
-        std::cerr << options.help();
-    } catch (const cxxopts::exceptions::exception& e) {
-        std::cerr << e.what() << '\n'
-                  << options.help();
-        return EXIT_FAILURE;
-    } catch (const std::exception& ec) {
-        std::cerr << ec.what() << '\n';
-        return EXIT_FAILURE;
-    }
-}
+#include "config.h"
+#include "audio_manager.hpp"
+#include "network_manager.hpp"
+
+#include <cmath>
+#include <cxxopts.hpp>
+#include <fmt/chrono.h>
+#include <iostream>
+#include <spdlog/spdlog.h>
+
+using string = std::string;
+
+int main(int argc, char* argv[])
+{
+    auto default_address = network_manager::get_default_address();
+
+    std::string help_string = "Example:\n";
+    help_string += fmt::format("  {} -b\n", AUDIO_SHARE_BIN_NAME);
+    help_string += fmt::format("  {} --bind={}\n", AUDIO_SHARE_BIN_NAME, default_address.empty() ? "192.168.3.2": default_address);
+    help_string += fmt::format("  {} --bind={} --encoding=f32 --channels=2 --sample-rate=48000\n", AUDIO_SHARE_BIN_NAME, default_address.empty() ? "192.168.3.2": default_address);
+    help_string += fmt::format("  {} -l\n", AUDIO_SHARE_BIN_NAME);
+    help_string += fmt::format("  {} --list-encoding\n", AUDIO_SHARE_BIN_NAME);
+    cxxopts::Options options(AUDIO_SHARE_BIN_NAME, help_string);
+
+    // clang-format off
+    options.add_options()
+        ("h,help", "Print usage")
+        ("l,list-endpoint", "List available endpoints")
+        ("b,bind", "The server bind address. If not set, will use default", cxxopts::value<string>()->implicit_value(default_address), "[host][:<port>]")
+        ("e,endpoint", "Specify the endpoint id. If not set or set \"default\", will use default", cxxopts::value<string>()->default_value("default"), "[endpoint]")
+        ("encoding", "Specify the capture encoding. If not set or set \"default\", will use default", cxxopts::value<audio_manager::encoding_t>()->default_value("default"), "[encoding]")
+        ("list-encoding", "List available encoding")
+        ("channels", "Specify the capture channels. If not set or set \"0\", will use default", cxxopts::value<int>()->default_value("0"), "[channels]")
+        ("sample-rate", "Specify the capture sample rate(Hz). If not set or set \"0\", will use default. The common values are 44100, 48000, etc.", cxxopts::value<int>()->default_value("0"), "[sample_rate]")
+        ("multicast", "Send to a multicast group the clients which support it", cxxopts::value<string>(), "<address>[:<port>]")
+        ("packet-duration", "Send packets of a fixed duration(ms), such as 2.5, 5, 10 or 20. If not set or set \"0\", every captured quantum is one packet", cxxopts::value<double>()->default_value("0"), "[duration]")
+        ("prebuffer", "Burst the last audio(ms) to a new client so it starts playing sooner. Set \"0\" to disable", cxxopts::value<uint32_t>()->default_value("100"), "[duration]")
+        ("max-in-flight", "The udp sends in flight per client. Past that, the audio is dropped", cxxopts::value<uint16_t>()->default_value("32"), "[count]")
+        ("max-sessions", "The max tcp sessions, high priority clients excepted. If not set or set \"0\", no limit", cxxopts::value<uint32_t>()->default_value("0"), "[count]")
+        ("max-players", "The max playing clients. If not set or set \"0\", no limit", cxxopts::value<uint32_t>()->default_value("0"), "[count]")
+        ("max-bandwidth", "The max bandwidth(kbps) of all the audio streams. If not set or set \"0\", no limit", cxxopts::value<uint32_t>()->default_value("0"), "[kbps]")
+        ("priority", "Set the priority class of the clients in a subnet. When capacity is short, lower classes are degraded, refused or preempted", cxxopts::value<std::vector<string>>(), "<address>[/<prefix>]=<low|normal|high>")
+        ("rt-priority", "Run the network thread with this realtime priority, falls back to RTKit on Linux. If not set or set \"0\", use the default scheduling", cxxopts::value<int>()->default_value("0"), "[1-99]")
+        ("capture-rt-priority", "Run the capture thread with this realtime priority. If not set or set \"0\", use the default scheduling", cxxopts::value<int>()->default_value("0"), "[1-99]")
+        ("rt-round-robin", "Use SCHED_RR instead of SCHED_FIFO for the realtime priorities")
+        ("net-cpus", "Pin the network thread to these CPUs", cxxopts::value<string>(), "<cpu>[-<cpu>][,...]")
+        ("capture-cpus", "Pin the capture thread to these CPUs", cxxopts::value<string>(), "<cpu>[-<cpu>][,...]")
+        ("busy-poll", "Spin on the network loop for this time(us) before sleeping, and busy poll the udp socket. It takes a core, pin it with --net-cpus. If not set or set \"0\", the loop sleeps", cxxopts::value<uint32_t>()->default_value("0"), "[us]")
+        ("benchmark-jitter", "Measure the timer jitter of the network loop with and without --busy-poll, then exit")
+        ("mlock", "Lock the server memory so the audio path never waits for a page fault")
+        ("flight-recorder", "Record the last pipeline events, and dump them to this directory on a send gap, a send queue overrun, a capture xrun or SIGUSR2", cxxopts::value<string>(), "<directory>")
+        ("metrics", "Serve Prometheus metrics on http://<host>:<port>/metrics. The host is 127.0.0.1 if not set", cxxopts::value<string>(), "[host:]<port>")
+        ("playout-delay", "Ask the clients playing in sync to play the audio this time(ms) after its capture. If not set or set \"0\", follow the farthest of them", cxxopts::value<uint32_t>()->default_value("0"), "[ms]")
+        ("tx-timestamps", "Measure the time from the udp send call to the wire with the kernel transmit timestamps, per client, Linux only. \"hardware\" needs an interface with hardware stamping and its clock synced to the system clock", cxxopts::value<string>()->default_value("off"), "<off|software|hardware>")
+        ("V,verbose", "Set log level to \"trace\"")
+        ("v,version", "Show version")
+        ;
+    // clang-format on
+
+    try {
+        auto result = options.parse(argc, argv);
+        if (result.count("help")) {
+            std::cout << options.help();
+            return EXIT_SUCCESS;
+        }
+
+        if (result.count("version")) {
+            fmt::println("{}\nversion: {}\nurl: {}\n", AUDIO_SHARE_BIN_NAME, AUDIO_SHARE_VERSION, AUDIO_SHARE_HOMEPAGE);
+            return EXIT_SUCCESS;
+        }
+
+        if (result.count("verbose")) {
+            spdlog::set_level(spdlog::level::trace);
+        }
+
+        if (result.count("list-endpoint")) {
+            auto audio_manager = std::make_shared<class audio_manager>();
+            auto endpoint_list = audio_manager->get_endpoint_list();
+            auto default_endpoint = audio_manager->get_default_endpoint();
+            auto s = fmt::format("endpoint list:\n");
+            for (auto&& [id, name] : endpoint_list) {
+                s += fmt::format("\t{} id: {:4} name: {}\n", (id == default_endpoint ? '*' : ' '), id, name);
+            }
+            s += fmt::format("total: {}\n", endpoint_list.size());
+            std::cout << s;
+            return EXIT_SUCCESS;
+        }
+
+        if (result.count("list-encoding")) {
+            std::vector<std::pair<string, string>> array = {
+                { "default", "Default encoding" },
+                { "f32", "32 bit floating-point PCM" },
+                { "s8", "8 bit integer PCM" },
+                { "s16", "16 bit integer PCM" },
+                { "s24", "24 bit integer PCM" },
+                { "s32", "32 bit integer PCM" },
+            };
+            fmt::println("encoding list:");
+            for(auto&& e : array) {
+                fmt::println("\t{}\t\t{}", e.first, e.second);
+            }
+            return EXIT_SUCCESS;
+        }
+
+        if (result.count("benchmark-jitter")) {
+            realtime::thread_config thread_config;
+            thread_config.priority = result["rt-priority"].as<int>();
+            thread_config.round_robin = result.count("rt-round-robin");
+            if (result.count("net-cpus")) {
+                thread_config.cpus = realtime::parse_cpu_list(result["net-cpus"].as<string>());
+            }
+            realtime::apply("benchmark", thread_config);
+
+            const auto period = std::chrono::milliseconds(1);
+            const size_t samples = 5000;
+            const auto spin = std::chrono::microseconds(std::max<uint32_t>(result["busy-poll"].as<uint32_t>(), 200));
+            fmt::println("timer lateness, period {}, {} samples", period, samples);
+            fmt::println("\t{:<16}{:>12}{:>12}{:>12}{:>12}", "loop", "p50", "p99", "p99.9", "max");
+            for (auto loop_spin : { std::chrono::microseconds(0), spin }) {
+                auto stats = event_loop::measure_jitter(period, samples, loop_spin);
+                auto name = loop_spin.count() ? fmt::format("busy-poll {}us", loop_spin.count()) : string("run");
+                fmt::println("\t{:<16}{:>12}{:>12}{:>12}{:>12}", name, stats.p50, stats.p99, stats.p999, stats.max);
+            }
+            return EXIT_SUCCESS;
+        }
+
+        if (result.count("bind")) {
+            auto s = result["bind"].as<string>();
+            size_t pos = s.find(':');
+            string host = s.substr(0, pos);
+            uint16_t port;
+            if (pos == string::npos) {
+                port = 65530;
+            } else {
+                port = (uint16_t)std::stoi(s.substr(pos + 1));
+            }
+
+            auto audio_manager = std::make_shared<class audio_manager>();
+
+            audio_manager::capture_config capture_config;
+
+            capture_config.endpoint_id = result["endpoint"].as<string>();
+            capture_config.encoding = result["encoding"].as<audio_manager::encoding_t>();
+            capture_config.channels = result["channels"].as<int>();
+            capture_config.sample_rate = result["sample-rate"].as<int>();
+            capture_config.thread.priority = result["capture-rt-priority"].as<int>();
+            capture_config.thread.round_robin = result.count("rt-round-robin");
+            if (result.count("capture-cpus")) {
+                capture_config.thread.cpus = realtime::parse_cpu_list(result["capture-cpus"].as<string>());
+            }
+
+            network_manager::server_config server_config;
+            server_config.prebuffer_ms = result["prebuffer"].as<uint32_t>();
+            server_config.max_in_flight = result["max-in-flight"].as<uint16_t>();
+            server_config.max_sessions = result["max-sessions"].as<uint32_t>();
+            server_config.max_players = result["max-players"].as<uint32_t>();
+            server_config.max_bandwidth = (uint64_t)result["max-bandwidth"].as<uint32_t>() * 1000;
+            if (result.count("priority")) {
+                server_config.priority_rules = result["priority"].as<std::vector<string>>();
+            }
+            server_config.net_thread.priority = result["rt-priority"].as<int>();
+            server_config.net_thread.round_robin = result.count("rt-round-robin");
+            if (result.count("net-cpus")) {
+                server_config.net_thread.cpus = realtime::parse_cpu_list(result["net-cpus"].as<string>());
+            }
+            server_config.lock_memory = result.count("mlock");
+            server_config.busy_poll_us = result["busy-poll"].as<uint32_t>();
+            if (result.count("flight-recorder")) {
+                server_config.flight_recorder_dir = result["flight-recorder"].as<string>();
+            }
+            if (result.count("metrics")) {
+                auto s = result["metrics"].as<string>();
+                size_t pos = s.rfind(':');
+                if (pos != string::npos) {
+                    server_config.metrics_address = s.substr(0, pos);
+                }
+                server_config.metrics_port = (uint16_t)std::stoi(s.substr(pos == string::npos ? 0 : pos + 1));
+            }
+            server_config.playout_delay_ms = result["playout-delay"].as<uint32_t>();
+            server_config.tx_timestamps = tx_timestamper::parse_mode(result["tx-timestamps"].as<string>());
+            server_config.packet_duration_us = (uint32_t)std::lround(std::max(result["packet-duration"].as<double>(), 0.0) * 1000);
+            if (result.count("multicast")) {
+                auto s = result["multicast"].as<string>();
+                size_t pos = s.find(':');
+                server_config.multicast_address = s.substr(0, pos);
+                if (pos != string::npos) {
+                    server_config.multicast_port = (uint16_t)std::stoi(s.substr(pos + 1));
+                }
+            }
+
+            auto network_manager = std::make_shared<class network_manager>(audio_manager);
+
+            network_manager->start_server(host, port, capture_config, server_config);
+            network_manager->wait_server();
+
+            return EXIT_SUCCESS;
+        }
+
+        // no arg
+        std::cerr << options.help();
+    } catch (const cxxopts::exceptions::exception& e) {
+        std::cerr << e.what() << '\n'
+                  << options.help();
+        return EXIT_FAILURE;
+    } catch (const std::exception& ec) {
+        std::cerr << ec.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
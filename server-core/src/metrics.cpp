@@ -0,0 +1,76 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "metrics.hpp"
+
+#include <deque>
+#include <mutex>
+
+#include <fmt/format.h>
+
+namespace metrics {
+
+namespace {
+
+    struct counter_info_t {
+        const char* name;
+        const char* help;
+    };
+
+    constexpr std::array<counter_info_t, counter_count> counter_info { {
+        { "audio_share_sent_bytes_total", "UDP bytes sent, packet headers included." },
+        { "audio_share_sent_datagrams_total", "UDP datagrams sent." },
+        { "audio_share_send_errors_total", "UDP sends which failed." },
+        { "audio_share_dropped_datagrams_total", "Datagrams dropped at the in-flight limit." },
+        { "audio_share_capture_quanta_total", "Buffers delivered by the capture backend." },
+        { "audio_share_capture_xruns_total", "Capture buffers lost or flagged as discontinuous." },
+        { "audio_share_heartbeat_timeouts_total", "Sessions and parked peers which timed out." },
+    } };
+
+    std::mutex g_threads_mutex;
+    std::deque<detail::thread_counters_t> g_threads; // never shrinks, a thread's counts outlive it
+
+} // namespace
+
+detail::thread_counters_t* detail::register_thread()
+{
+    std::lock_guard lock(g_threads_mutex);
+    return &g_threads.emplace_back();
+}
+
+uint64_t total(counter_t counter)
+{
+    std::lock_guard lock(g_threads_mutex);
+    uint64_t sum = 0;
+    for (auto& thread : g_threads) {
+        sum += thread.values[counter].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void append_metric(std::string& out, const char* name, const char* type, const char* help, double value)
+{
+    fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n{} {}\n", name, help, name, type, name, value);
+}
+
+void append_counters(std::string& out)
+{
+    for (size_t i = 0; i < counter_count; ++i) {
+        append_metric(out, counter_info[i].name, "counter", counter_info[i].help, (double)total((counter_t)i));
+    }
+}
+
+} // namespace metrics
@@ -0,0 +1,74 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Process wide counters, exported in the Prometheus text format.
+// Every thread writes to its own cache line with relaxed stores, a scrape sums the lines of all the threads,
+// so counting never waits for anything and never shares a line with another writer.
+namespace metrics {
+
+enum counter_t : uint8_t {
+    counter_bytes_sent,         // udp payload, headers included
+    counter_datagrams_sent,
+    counter_send_errors,
+    counter_dropped_datagrams,  // dropped at the in-flight limit
+    counter_capture_quanta,
+    counter_xruns,              // capture buffers lost or flagged as discontinuous
+    counter_heartbeat_timeouts,
+    counter_count,
+};
+
+namespace detail {
+
+    struct alignas(64) thread_counters_t {
+        std::array<std::atomic<uint64_t>, counter_count> values {};
+    };
+
+    thread_counters_t* register_thread();
+
+    inline thread_counters_t& local()
+    {
+        thread_local thread_counters_t* counters = register_thread();
+        return *counters;
+    }
+
+} // namespace detail
+
+// only the calling thread writes its line, a plain load and store is enough
+inline void add(counter_t counter, uint64_t value = 1)
+{
+    auto& slot = detail::local().values[counter];
+    slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+uint64_t total(counter_t counter);
+
+// "# HELP", "# TYPE" and the sample of a metric without labels
+void append_metric(std::string& out, const char* name, const char* type, const char* help, double value);
+
+// the process counters, in the text format
+void append_counters(std::string& out);
+
+} // namespace metrics
+
+#endif // !METRICS_HPP
@@ -1,425 +1,1770 @@
-/*
-   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
-
-   Licensed under the Apache License, Version 2.0 (the "License");
-   you may not use this file except in compliance with the License.
-   You may obtain a copy of the License at
-
-       http://www.apache.org/licenses/LICENSE-2.0
-
-   Unless required by applicable law or agreed to in writing, software
-   distributed under the License is distributed on an "AS IS" BASIS,
-   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-   See the License for the specific language governing permissions and
-   limitations under the License.
-*/
-
-#include "network_manager.hpp"
-#include "formatter.hpp"
-#include "audio_manager.hpp"
-
-#include <list>
-#include <ranges>
-#include <coroutine>
-
-#ifdef _WINDOWS
-#include <iphlpapi.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "Ws2_32.lib")
-#pragma comment(lib, "Iphlpapi.lib")
-#endif // _WINDOWS
-
-#ifdef linux
-#include <sys/types.h>
-#include <ifaddrs.h>
-#endif
-
-#include <spdlog/spdlog.h>
-#include <fmt/ranges.h>
-
-namespace ip = asio::ip;
-using namespace std::chrono_literals;
-
-network_manager::network_manager(std::shared_ptr<audio_manager>& audio_manager)
-    : _audio_manager(audio_manager)
-{
-}
-
-std::vector<std::string> network_manager::get_address_list()
-{
-    std::vector<std::string> address_list;
-
-#ifdef _WINDOWS
-    ULONG family = AF_INET;
-    ULONG flags = GAA_FLAG_INCLUDE_ALL_INTERFACES;
-
-    ULONG size = 0;
-    GetAdaptersAddresses(family, flags, nullptr, nullptr, &size);
-    auto pAddresses = (PIP_ADAPTER_ADDRESSES)malloc(size);
-
-    auto ret = GetAdaptersAddresses(family, flags, nullptr, pAddresses, &size);
-    if (ret == ERROR_SUCCESS) {
-        for (auto pCurrentAddress = pAddresses; pCurrentAddress; pCurrentAddress = pCurrentAddress->Next) {
-            if (pCurrentAddress->OperStatus != IfOperStatusUp || pCurrentAddress->IfType == IF_TYPE_SOFTWARE_LOOPBACK) {
-                continue;
-            }
-
-            for (auto pUnicast = pCurrentAddress->FirstUnicastAddress; pUnicast; pUnicast = pUnicast->Next) {
-                auto sockaddr = (sockaddr_in*)pUnicast->Address.lpSockaddr;
-                char buf[50];
-                if (inet_ntop(AF_INET, &sockaddr->sin_addr, buf, sizeof(buf))) {
-                    address_list.emplace_back(buf);
-                }
-            }
-        }
-    }
-
-    free(pAddresses);
-#endif
-
-#ifdef linux
-    struct ifaddrs* ifaddrs;
-    if (getifaddrs(&ifaddrs) == -1) {
-        return address_list;
-    }
-
-    for (auto ifa = ifaddrs; ifa; ifa = ifa->ifa_next) {
-        if (!ifa->ifa_addr) {
-            continue;
-        }
-        if (ifa->ifa_addr->sa_family != AF_INET) {
-            continue;
-        }
-        if (ifa->ifa_flags & IFF_LOOPBACK) {
-            continue;
-        }
-        auto sockaddr = (sockaddr_in*)ifa->ifa_addr;
-        char buf[50];
-        if (inet_ntop(AF_INET, &sockaddr->sin_addr, buf, sizeof(buf))) {
-            address_list.emplace_back(buf);
-        }
-    }
-
-    freeifaddrs(ifaddrs);
-#endif
-
-    return address_list;
-}
-
-std::string network_manager::get_default_address()
-{
-    return select_default_address(get_address_list());
-}
-
-std::string network_manager::select_default_address(const std::vector<std::string>& address_list)
-{
-    if (address_list.empty()) {
-        return {};
-    }
-
-    auto is_private_address = [](const std::string& address) {
-        constexpr uint32_t private_addr_list[] = {
-            0x0a000000,
-            0xac100000,
-            0xc0a80000,
-        };
-
-        uint32_t addr;
-        inet_pton(AF_INET, address.c_str(), &addr);
-        addr = ntohl(addr);
-        for (auto&& private_addr : private_addr_list) {
-            if ((addr & private_addr) == private_addr) {
-                return true;
-            }
-        }
-
-        return false;
-    };
-
-    for (auto&& address : address_list) {
-        if (is_private_address(address)) {
-            return address;
-        }
-    }
-    return address_list.front();
-}
-
-void network_manager::start_server(const std::string& host, uint16_t port, const audio_manager::capture_config& capture_config)
-{
-    _ioc = std::make_shared<asio::io_context>();
-    {
-        ip::tcp::endpoint endpoint { ip::make_address(host), port };
-
-        ip::tcp::acceptor acceptor(*_ioc, endpoint.protocol());
-        acceptor.set_option(ip::tcp::acceptor::reuse_address(true));
-        acceptor.bind(endpoint);
-        acceptor.listen();
-
-        _audio_manager->start_loopback_recording(shared_from_this(), capture_config);
-        asio::co_spawn(*_ioc, accept_tcp_loop(std::move(acceptor)), asio::detached);
-
-        // start tcp success
-        spdlog::info("tcp listen success on {}", endpoint);
-    }
-
-    {
-        ip::udp::endpoint endpoint { ip::make_address(host), port };
-        _udp_server = std::make_unique<udp_socket>(*_ioc, endpoint.protocol());
-        _udp_server->bind(endpoint);
-        asio::co_spawn(*_ioc, accept_udp_loop(), asio::detached);
-
-        // start udp success
-        spdlog::info("udp listen success on {}", endpoint);
-    }
-
-    _net_thread = std::thread([self = shared_from_this()] {
-        self->_ioc->run();
-    });
-
-    spdlog::info("server started");
-}
-
-void network_manager::stop_server()
-{
-    if (_ioc) {
-        _ioc->stop();
-    }
-    _net_thread.join();
-    _audio_manager->stop();
-    _playing_peer_list.clear();
-    _udp_server = nullptr;
-    _ioc = nullptr;
-    spdlog::info("server stopped");
-}
-
-void network_manager::wait_server()
-{
-    _net_thread.join();
-}
-
-bool network_manager::is_running() const
-{
-    return _ioc != nullptr;
-}
-
-asio::awaitable<void> network_manager::read_loop(std::shared_ptr<tcp_socket> peer)
-{
-    while (true) {
-        cmd_t cmd = cmd_t::cmd_none;
-        auto [ec, _] = co_await asio::async_read(*peer, asio::buffer(&cmd, sizeof(cmd)));
-        if (ec) {
-            close_session(peer);
-            spdlog::trace("{} {}", __func__, ec);
-            break;
-        }
-
-        spdlog::trace("cmd {}", (uint32_t)cmd);
-
-        if (cmd == cmd_t::cmd_get_format) {
-            auto format = _audio_manager->get_format_binary();
-            auto size = (uint32_t)format.size();
-            std::array<asio::const_buffer, 3> buffers = {
-                asio::buffer(&cmd, sizeof(cmd)),
-                asio::buffer(&size, sizeof(size)),
-                asio::buffer(format),
-            };
-            auto [ec, _] = co_await asio::async_write(*peer, buffers);
-            if (ec) {
-                close_session(peer);
-                spdlog::trace("{} {}", __func__, ec);
-                break;
-            }
-        } else if (cmd == cmd_t::cmd_start_play) {
-            int id = add_playing_peer(peer);
-            if (id <= 0) {
-                spdlog::error("{} id error", __func__);
-                close_session(peer);
-                spdlog::trace("{} {}", __func__, ec);
-                break;
-            }
-            std::array<asio::const_buffer, 2> buffers = {
-                asio::buffer(&cmd, sizeof(cmd)),
-                asio::buffer(&id, sizeof(id)),
-            };
-            auto [ec, _] = co_await asio::async_write(*peer, buffers);
-            if (ec) {
-                spdlog::trace("{} {}", __func__, ec);
-                close_session(peer);
-                break;
-            }
-            asio::co_spawn(*_ioc, heartbeat_loop(peer), asio::detached);
-        } else if (cmd == cmd_t::cmd_heartbeat) {
-            auto it = _playing_peer_list.find(peer);
-            if (it != _playing_peer_list.end()) {
-                it->second->last_tick = std::chrono::steady_clock::now();
-            }
-        } else {
-            spdlog::error("{} error cmd", __func__);
-            close_session(peer);
-            break;
-        }
-    }
-    spdlog::trace("stop {}", __func__);
-}
-
-asio::awaitable<void> network_manager::heartbeat_loop(std::shared_ptr<tcp_socket> peer)
-{
-    std::error_code ec;
-    size_t _;
-
-    steady_timer timer(*_ioc);
-    while (true) {
-        timer.expires_after(3s);
-        std::tie(ec) = co_await timer.async_wait();
-        if (ec) {
-            break;
-        }
-
-        if (!peer->is_open()) {
-            break;
-        }
-
-        auto it = _playing_peer_list.find(peer);
-        if (it == _playing_peer_list.end()) {
-            spdlog::trace("{} it == _playing_peer_list.end()", __func__);
-            close_session(peer);
-            break;
-        }
-        if (std::chrono::steady_clock::now() - it->second->last_tick > _heartbeat_timeout) {
-            spdlog::info("{} timeout", it->first->remote_endpoint());
-            close_session(peer);
-            break;
-        }
-
-        auto cmd = cmd_t::cmd_heartbeat;
-        std::tie(ec, _) = co_await asio::async_write(*peer, asio::buffer(&cmd, sizeof(cmd)));
-        if (ec) {
-            spdlog::trace("{} {}", __func__, ec);
-            close_session(peer);
-            break;
-        }
-    }
-    spdlog::trace("stop {}", __func__);
-}
-
-asio::awaitable<void> network_manager::accept_tcp_loop(tcp_acceptor acceptor)
-{
-    while (true) {
-        auto peer = std::make_shared<tcp_socket>(acceptor.get_executor());
-        auto [ec] = co_await acceptor.async_accept(*peer);
-        if (ec) {
-            spdlog::error("{} {}", __func__, ec);
-            co_return;
-        }
-
-        spdlog::info("accept {}", peer->remote_endpoint());
-
-        // No-Delay
-        peer->set_option(ip::tcp::no_delay(true), ec);
-        if (ec) {
-            spdlog::info("{} {}", __func__, ec);
-        }
-
-        asio::co_spawn(acceptor.get_executor(), read_loop(peer), asio::detached);
-    }
-}
-
-asio::awaitable<void> network_manager::accept_udp_loop()
-{
-    while (true) {
-        int id = 0;
-        ip::udp::endpoint udp_peer;
-        auto [ec, _] = co_await _udp_server->async_receive_from(asio::buffer(&id, sizeof(id)), udp_peer);
-        if (ec) {
-            spdlog::info("{} {}", __func__, ec);
-            co_return;
-        }
-
-        fill_udp_peer(id, udp_peer);
-    }
-}
-
-auto network_manager::close_session(std::shared_ptr<tcp_socket>& peer) -> playing_peer_list_t::iterator
-{
-    spdlog::info("close {}", peer->remote_endpoint());
-    auto it = remove_playing_peer(peer);
-    peer->shutdown(ip::tcp::socket::shutdown_both);
-    peer->close();
-    return it;
-}
-
-int network_manager::add_playing_peer(std::shared_ptr<tcp_socket>& peer)
-{
-    if (_playing_peer_list.contains(peer)) {
-        spdlog::error("{} repeat add tcp://{}", __func__, peer->remote_endpoint());
-        return 0;
-    }
-
-    auto info = _playing_peer_list[peer] = std::make_shared<peer_info_t>();
-    static int g_id = 0;
-    info->id = ++g_id;
-    info->last_tick = std::chrono::steady_clock::now();
-
-    spdlog::trace("{} add id:{} tcp://{}", __func__, info->id, peer->remote_endpoint());
-    return info->id;
-}
-
-auto network_manager::remove_playing_peer(std::shared_ptr<tcp_socket>& peer) -> playing_peer_list_t::iterator
-{
-    auto it = _playing_peer_list.find(peer);
-    if (it == _playing_peer_list.end()) {
-        spdlog::error("{} repeat remove tcp://{}", __func__, peer->remote_endpoint());
-        return it;
-    }
-
-    it = _playing_peer_list.erase(it);
-    spdlog::trace("{} remove tcp://{}", __func__, peer->remote_endpoint());
-    return it;
-}
-
-void network_manager::fill_udp_peer(int id, asio::ip::udp::endpoint udp_peer)
-{
-    auto it = std::find_if(_playing_peer_list.begin(), _playing_peer_list.end(), [id](const playing_peer_list_t::value_type& e) {
-        return e.second->id == id;
-    });
-
-    if (it == _playing_peer_list.cend()) {
-        spdlog::error("{} no tcp peer id:{} udp://{}", __func__, id, udp_peer);
-        return;
-    }
-
-    it->second->udp_peer = udp_peer;
-    spdlog::info("{} fill udp peer id:{} tcp://{} udp://{}", __func__, id, it->first->remote_endpoint(), udp_peer);
-}
-
-void network_manager::broadcast_audio_data(const char* data, size_t count, int block_align)
-{
-    if (count <= 0) {
-        return;
-    }
-    // spdlog::trace("broadcast_audio_data count: {}", count);
-
-    // divide udp frame
-    constexpr int mtu = 1492;
-    int max_seg_size = mtu - 20 - 8;
-    max_seg_size -= max_seg_size % block_align; // one single sample can't be divided
-
-    std::list<std::shared_ptr<std::vector<uint8_t>>> seg_list;
-
-    for (int begin_pos = 0; begin_pos < count;) {
-        const int real_seg_size = std::min((int)count - begin_pos, max_seg_size);
-        auto seg = std::make_shared<std::vector<uint8_t>>(real_seg_size);
-        std::copy((const uint8_t*)data + begin_pos, (const uint8_t*)data + begin_pos + real_seg_size, seg->begin());
-        seg_list.push_back(seg);
-        begin_pos += real_seg_size;
-    }
-
-    _ioc->post([seg_list = std::move(seg_list), self = shared_from_this()] {
-        for (const auto& seg : seg_list) {
-            for (auto& [peer, info] : self->_playing_peer_list) {
-                self->_udp_server->async_send_to(asio::buffer(*seg), info->udp_peer, [seg](const asio::error_code& ec, std::size_t bytes_transferred) { });
-            }
-        }
-    });
-}
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "network_manager.hpp"
+#include "formatter.hpp"
+#include "audio_manager.hpp"
+#include "sample_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <ranges>
+#include <coroutine>
+
+#ifdef _WINDOWS
+#include <iphlpapi.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#pragma comment(lib, "Iphlpapi.lib")
+#endif // _WINDOWS
+
+#ifdef linux
+#include <sys/types.h>
+#include <ifaddrs.h>
+#endif
+
+#include <spdlog/spdlog.h>
+#include <fmt/ranges.h>
+
+namespace ip = asio::ip;
+namespace pb = io::github::mkckr0::audio_share_app::pb;
+using namespace std::chrono_literals;
+
+network_manager::network_manager(std::shared_ptr<audio_manager>& audio_manager)
+    : _audio_manager(audio_manager)
+{
+}
+
+std::vector<std::string> network_manager::get_address_list()
+{
+    std::vector<std::string> address_list;
+
+#ifdef _WINDOWS
+    ULONG family = AF_INET;
+    ULONG flags = GAA_FLAG_INCLUDE_ALL_INTERFACES;
+
+    ULONG size = 0;
+    GetAdaptersAddresses(family, flags, nullptr, nullptr, &size);
+    auto pAddresses = (PIP_ADAPTER_ADDRESSES)malloc(size);
+
+    auto ret = GetAdaptersAddresses(family, flags, nullptr, pAddresses, &size);
+    if (ret == ERROR_SUCCESS) {
+        for (auto pCurrentAddress = pAddresses; pCurrentAddress; pCurrentAddress = pCurrentAddress->Next) {
+            if (pCurrentAddress->OperStatus != IfOperStatusUp || pCurrentAddress->IfType == IF_TYPE_SOFTWARE_LOOPBACK) {
+                continue;
+            }
+
+            for (auto pUnicast = pCurrentAddress->FirstUnicastAddress; pUnicast; pUnicast = pUnicast->Next) {
+                auto sockaddr = (sockaddr_in*)pUnicast->Address.lpSockaddr;
+                char buf[50];
+                if (inet_ntop(AF_INET, &sockaddr->sin_addr, buf, sizeof(buf))) {
+                    address_list.emplace_back(buf);
+                }
+            }
+        }
+    }
+
+    free(pAddresses);
+#endif
+
+#ifdef linux
+    struct ifaddrs* ifaddrs;
+    if (getifaddrs(&ifaddrs) == -1) {
+        return address_list;
+    }
+
+    for (auto ifa = ifaddrs; ifa; ifa = ifa->ifa_next) {
+        if (!ifa->ifa_addr) {
+            continue;
+        }
+        if (ifa->ifa_addr->sa_family != AF_INET) {
+            continue;
+        }
+        if (ifa->ifa_flags & IFF_LOOPBACK) {
+            continue;
+        }
+        auto sockaddr = (sockaddr_in*)ifa->ifa_addr;
+        char buf[50];
+        if (inet_ntop(AF_INET, &sockaddr->sin_addr, buf, sizeof(buf))) {
+            address_list.emplace_back(buf);
+        }
+    }
+
+    freeifaddrs(ifaddrs);
+#endif
+
+    return address_list;
+}
+
+std::string network_manager::get_default_address()
+{
+    return select_default_address(get_address_list());
+}
+
+std::string network_manager::select_default_address(const std::vector<std::string>& address_list)
+{
+    if (address_list.empty()) {
+        return {};
+    }
+
+    auto is_private_address = [](const std::string& address) {
+        constexpr uint32_t private_addr_list[] = {
+            0x0a000000,
+            0xac100000,
+            0xc0a80000,
+        };
+
+        uint32_t addr;
+        inet_pton(AF_INET, address.c_str(), &addr);
+        addr = ntohl(addr);
+        for (auto&& private_addr : private_addr_list) {
+            if ((addr & private_addr) == private_addr) {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    for (auto&& address : address_list) {
+        if (is_private_address(address)) {
+            return address;
+        }
+    }
+    return address_list.front();
+}
+
+void network_manager::start_server(const std::string& host, uint16_t port, const audio_manager::capture_config& capture_config, const server_config& server_config)
+{
+    rt_log::start();
+    _ioc = std::make_shared<asio::io_context>();
+    _profile_list.assign(1, {});
+    _profile_list[0].profile = output_profile_t::native();
+    update_format_binary(0);
+    _frame_position = 0;
+    _packet_duration_us = server_config.packet_duration_us;
+    _prebuffer_ms = server_config.prebuffer_ms;
+    _max_in_flight = std::max<uint16_t>(server_config.max_in_flight, 1);
+    _multicast_in_flight = 0;
+    _max_sessions = server_config.max_sessions;
+    _max_players = server_config.max_players;
+    _max_bandwidth = server_config.max_bandwidth;
+    _playout_delay_config_us = server_config.playout_delay_ms * 1000;
+    _playout_delay_us = _playout_delay_config_us ? _playout_delay_config_us : (uint32_t)std::chrono::microseconds(_min_playout_delay).count();
+    _priority_rules.clear();
+    for (auto& rule : server_config.priority_rules) {
+        _priority_rules.push_back(admission::parse_rule(rule));
+    }
+    if (server_config.lock_memory) {
+        realtime::lock_memory();
+    }
+    if (!server_config.flight_recorder_dir.empty()) {
+        flight_recorder::start(server_config.flight_recorder_dir);
+    }
+    {
+        ip::tcp::endpoint endpoint { ip::make_address(host), port };
+
+        ip::tcp::acceptor acceptor(*_ioc, endpoint.protocol());
+        acceptor.set_option(ip::tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+
+        // the capture starts paused, the first cmd_start_play resumes it
+        set_capture_active(false);
+        _audio_manager->start_loopback_recording(shared_from_this(), capture_config);
+        asio::co_spawn(*_ioc, accept_tcp_loop(std::move(acceptor)), asio::detached);
+
+        // start tcp success
+        rt_log::info("tcp listen success on {}", endpoint);
+    }
+
+    {
+        ip::udp::endpoint endpoint { ip::make_address(host), port };
+        _udp_server = std::make_unique<udp_socket>(*_ioc, endpoint.protocol());
+        _udp_server->bind(endpoint);
+        if (server_config.busy_poll_us) {
+            event_loop::set_busy_poll(_udp_server->native_handle(), std::chrono::microseconds(server_config.busy_poll_us));
+        }
+        asio::co_spawn(*_ioc, accept_udp_loop(), asio::detached);
+        if (server_config.tx_timestamps != tx_timestamper::mode_off && _tx_timestamper.enable(_udp_server->native_handle(), server_config.tx_timestamps)) {
+            asio::co_spawn(*_ioc, tx_timestamp_loop(), asio::detached);
+        }
+
+        // start udp success
+        rt_log::info("udp listen success on {}", endpoint);
+
+        if (!server_config.multicast_address.empty()) {
+            _multicast_endpoint = { ip::make_address(server_config.multicast_address), server_config.multicast_port ? server_config.multicast_port : port };
+            if (!_multicast_endpoint.address().is_multicast()) {
+                rt_log::error("{} is not a multicast address", _multicast_endpoint.address().to_string());
+            } else {
+                _udp_server->set_option(ip::multicast::hops(1));
+                if (endpoint.address().is_v4() && !endpoint.address().is_unspecified()) {
+                    _udp_server->set_option(ip::multicast::outbound_interface(endpoint.address().to_v4()));
+                }
+                _multicast_enabled = true;
+                rt_log::info("multicast on {}", _multicast_endpoint);
+            }
+        }
+    }
+
+    if (server_config.metrics_port) {
+        ip::tcp::endpoint endpoint { ip::make_address(server_config.metrics_address), server_config.metrics_port };
+        ip::tcp::acceptor acceptor(*_ioc, endpoint.protocol());
+        acceptor.set_option(ip::tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+        asio::co_spawn(*_ioc, accept_metrics_loop(std::move(acceptor)), asio::detached);
+        rt_log::info("metrics on http://{}/metrics", endpoint);
+    }
+
+    _wheel_timer = std::make_unique<steady_timer>(*_ioc);
+    asio::co_spawn(*_ioc, timer_loop(), asio::detached);
+#ifdef SIGUSR1
+    asio::co_spawn(*_ioc, signal_loop(), asio::detached);
+#endif // SIGUSR1
+
+    _net_thread = std::thread([self = shared_from_this(), thread_config = server_config.net_thread, spin = std::chrono::microseconds(server_config.busy_poll_us)] {
+        realtime::apply("network", thread_config);
+        realtime::prefault();
+        event_loop::run(*self->_ioc, spin);
+    });
+
+    rt_log::info("server started");
+}
+
+void network_manager::stop_server()
+{
+    if (_ioc) {
+        _ioc->stop();
+    }
+    _net_thread.join();
+    _audio_manager->stop();
+    _playing_peer_list.clear();
+    _token_index.clear();
+    _session_list.clear();
+    _profile_list.clear();
+    _multicast_enabled = false;
+    _timer_wheel.clear();
+    _wheel_timer = nullptr;
+    if (_tx_timestamper.enabled()) {
+        rt_log::info("tx timestamps lost:{}", _tx_timestamper.lost());
+        _tx_timestamper.reset();
+    }
+    _udp_server = nullptr;
+    _ioc = nullptr;
+    flight_recorder::stop();
+    auto stats = handler_memory::stats();
+    rt_log::info("server stopped, handler memory allocations:{} heap:{} dropped log messages:{}", stats.allocations, stats.heap_allocations, rt_log::dropped());
+    rt_log::stop();
+}
+
+void network_manager::wait_server()
+{
+    _net_thread.join();
+}
+
+bool network_manager::is_running() const
+{
+    return _ioc != nullptr;
+}
+
+asio::awaitable<void> network_manager::read_loop(std::shared_ptr<session_t> session)
+{
+    auto& reader = session->reader;
+    while (true) {
+        auto [ec, n] = co_await session->socket.async_read_some(reader.prepare());
+        if (ec) {
+            close_session(session);
+            rt_log::trace("{} {}", __func__, ec);
+            break;
+        }
+        reader.commit(n);
+
+        // handle every complete frame of this read
+        frame_reader::frame_t frame;
+        auto result = frame_reader::result_t::ok;
+        while ((result = reader.next(frame)) == frame_reader::result_t::ok) {
+            if (!handle_frame(session, frame)) {
+                close_session(session);
+                break;
+            }
+        }
+        if (result == frame_reader::result_t::error) {
+            rt_log::error("{} frame too large", __func__);
+            close_session(session);
+        }
+        if (!session->socket.is_open()) {
+            break;
+        }
+    }
+    rt_log::trace("stop {}", __func__);
+}
+
+bool network_manager::handle_frame(const std::shared_ptr<session_t>& session, const frame_reader::frame_t& frame)
+{
+    auto cmd = (cmd_t)frame.cmd;
+    rt_log::trace("cmd {}", frame.cmd);
+
+    std::string reply;
+    if (cmd == cmd_t::cmd_get_format) {
+        session->format_version = _capture_format.version();
+        protocol::append_frame(reply, cmd, _profile_list[session->profile].format_binary);
+    } else if (cmd == cmd_t::cmd_format_changed) {
+        session->format_push = true;
+        session->format_version = _capture_format.version();
+        protocol::append_frame(reply, cmd, _profile_list[session->profile].format_binary);
+    } else if (cmd == cmd_t::cmd_hello) {
+        if (!handle_hello(session, frame.payload, reply)) {
+            return false;
+        }
+    } else if (cmd == cmd_t::cmd_start_play) {
+        // before admit(), which may preempt other peers or change the profile of this one
+        if (_playing_peer_list.find(session.get()) != playing_peer_list_t::npos) {
+            rt_log::error("{} repeat start tcp://{}", __func__, session->remote_endpoint);
+            return false;
+        }
+        if (!admit(session)) {
+            if (!session->hello) {
+                // a legacy client only understands a closed connection
+                return false;
+            }
+            protocol::append_frame(reply, cmd_t::cmd_refused, {});
+            send(session, reply);
+            return true;
+        }
+
+        int id = add_playing_peer(session);
+        if (id <= 0) {
+            rt_log::error("{} id error", __func__);
+            return false;
+        }
+        protocol::append_cmd(reply, cmd);
+        protocol::append_value(reply, id);
+
+        if (session->hello) {
+            auto slot = _playing_peer_list.find(id);
+            uint64_t token;
+            do {
+                token = (uint64_t)_token_source() << 32 | _token_source();
+            } while (token == 0 || _token_index.contains(token));
+            _playing_peer_list.info(slot).token = token;
+            _token_index.emplace(token, id);
+            protocol::append_frame(reply, cmd_t::cmd_session_token, { (const char*)&token, sizeof(token) });
+        }
+    } else if (cmd == cmd_t::cmd_resume) {
+        resume_session(session, frame.payload, reply);
+    } else if (cmd == cmd_t::cmd_heartbeat) {
+        auto slot = _playing_peer_list.find(session.get());
+        if (slot != playing_peer_list_t::npos) {
+            _playing_peer_list.info(slot).last_tick = std::chrono::steady_clock::now();
+        }
+    } else if (protocol::is_framed(frame.cmd)) {
+        // sent by a newer client, skip it
+        rt_log::trace("{} unknown cmd {} size {}", __func__, frame.cmd, frame.payload.size());
+    } else {
+        rt_log::error("{} error cmd", __func__);
+        return false;
+    }
+
+    if (!reply.empty()) {
+        send(session, reply);
+    }
+    return true;
+}
+
+bool network_manager::handle_hello(const std::shared_ptr<session_t>& session, std::string_view payload, std::string& reply)
+{
+    pb::ClientHello client_hello;
+    if (!client_hello.ParseFromArray(payload.data(), (int)payload.size())) {
+        rt_log::error("{} bad ClientHello", __func__);
+        return false;
+    }
+    if (session->hello || _playing_peer_list.find(session.get()) != playing_peer_list_t::npos) {
+        rt_log::error("{} hello after negotiation or start play", __func__);
+        return false;
+    }
+
+    auto profile = output_profile_t::select(client_hello, _capture_format.encoding(), _multicast_enabled);
+    session->hello = true;
+    session->profile = acquire_profile(profile);
+    session->jitter_buffer_ms = client_hello.jitter_buffer_ms();
+    if (client_hello.format_push()) {
+        session->format_push = true;
+        session->format_version = _capture_format.version();
+    }
+    // a step is a format change
+    session->adaptive_bitrate = client_hello.adaptive_bitrate() && session->format_push && profile.packet_header && !profile.multicast;
+
+    pb::ServerHello server_hello;
+    server_hello.set_protocol_version(protocol::version);
+    *server_hello.mutable_format() = _profile_list[session->profile].profile.make_format(_capture_format);
+    server_hello.set_max_payload_size(profile.max_payload_size);
+    server_hello.set_packet_header(profile.packet_header);
+    server_hello.set_format_push(session->format_push);
+    server_hello.set_adaptive_rate(profile.adaptive_rate);
+    server_hello.set_presentation_time(profile.presentation_time);
+    server_hello.set_adaptive_bitrate(session->adaptive_bitrate);
+    server_hello.set_playout_delay_us(_playout_delay_us);
+    if (profile.multicast) {
+        server_hello.set_transport(pb::ServerHello_Transport_TRANSPORT_UDP_MULTICAST);
+        server_hello.set_multicast_address(_multicast_endpoint.address().to_string());
+        server_hello.set_multicast_port(_multicast_endpoint.port());
+    } else {
+        server_hello.set_transport(pb::ServerHello_Transport_TRANSPORT_UDP_UNICAST);
+    }
+    protocol::append_frame(reply, cmd_t::cmd_hello, server_hello.SerializeAsString());
+
+    rt_log::info("{} tcp://{} version:{} profile:{} encoding:{} payload:{} header:{} multicast:{}", __func__, session->remote_endpoint,
+        client_hello.protocol_version(), session->profile, (int)server_hello.format().encoding(), profile.max_payload_size, profile.packet_header, profile.multicast);
+    return true;
+}
+
+void network_manager::resume_session(const std::shared_ptr<session_t>& session, std::string_view payload, std::string& reply)
+{
+    uint64_t token = 0;
+    if (payload.size() == sizeof(token)) {
+        std::memcpy(&token, payload.data(), sizeof(token));
+    }
+    auto it = _token_index.find(token);
+    if (it == _token_index.end() || session->hello || _playing_peer_list.find(session.get()) != playing_peer_list_t::npos) {
+        rt_log::info("{} tcp://{} refused", __func__, session->remote_endpoint);
+        protocol::append_frame(reply, cmd_t::cmd_resume, {});
+        return;
+    }
+
+    const int id = it->second;
+    auto slot = _playing_peer_list.find(id);
+    auto old_session = _playing_peer_list.connection(slot);
+
+    // take over the negotiated state, the profile reference moves with it
+    session->hello = old_session->hello;
+    session->profile = old_session->profile;
+    session->jitter_buffer_ms = old_session->jitter_buffer_ms;
+    session->format_push = old_session->format_push;
+    session->format_version = old_session->format_version;
+    session->adaptive_bitrate = old_session->adaptive_bitrate;
+    old_session->hello = false;
+
+    _playing_peer_list.rebind(slot, session);
+    auto& info = _playing_peer_list.info(slot);
+    info.parked = false;
+    info.last_tick = std::chrono::steady_clock::now();
+
+    // the old connection may not have noticed the blip yet
+    close_session(old_session);
+
+    protocol::append_frame(reply, cmd_t::cmd_resume, { (const char*)&id, sizeof(id) });
+    if (session->format_push && session->format_version != _capture_format.version()) {
+        session->format_version = _capture_format.version();
+        protocol::append_frame(reply, cmd_t::cmd_format_changed, _profile_list[session->profile].format_binary);
+    }
+    rt_log::info("{} id:{} tcp://{}", __func__, id, session->remote_endpoint);
+}
+
+void network_manager::send(const std::shared_ptr<session_t>& session, std::string_view data)
+{
+    session->outbox.append(data);
+    flush(session);
+}
+
+void network_manager::flush(const std::shared_ptr<session_t>& session)
+{
+    // one write in flight per session, everything queued meanwhile goes out in the next one
+    if (!session->sending.empty() || session->outbox.empty() || !session->socket.is_open()) {
+        return;
+    }
+
+    session->sending.swap(session->outbox);
+    asio::async_write(session->socket, asio::buffer(session->sending), asio::bind_allocator(handler_allocator<void>(), [self = shared_from_this(), session](const asio::error_code& ec, std::size_t) {
+        session->sending.clear();
+        if (ec) {
+            rt_log::trace("flush {}", ec.message());
+            self->close_session(session);
+            return;
+        }
+        self->flush(session);
+    }));
+}
+
+asio::awaitable<void> network_manager::accept_tcp_loop(tcp_acceptor acceptor)
+{
+    while (true) {
+        auto session = std::make_shared<session_t>(acceptor.get_executor());
+        auto [ec] = co_await acceptor.async_accept(session->socket);
+        if (ec) {
+            rt_log::error("{} {}", __func__, ec);
+            co_return;
+        }
+
+        session->remote_endpoint = session->socket.remote_endpoint(ec);
+        session->priority = admission::classify(_priority_rules, session->remote_endpoint.address());
+        rt_log::info("accept {} priority:{}", session->remote_endpoint, admission::to_string(session->priority));
+
+        if (_max_sessions && _session_list.size() >= _max_sessions && session->priority != admission::priority_t::priority_high) {
+            rt_log::info("{} too many sessions, refuse {}", __func__, session->remote_endpoint);
+            session->socket.close(ec);
+            continue;
+        }
+
+        // No-Delay
+        session->socket.set_option(ip::tcp::no_delay(true), ec);
+        if (ec) {
+            rt_log::info("{} {}", __func__, ec);
+        }
+
+        _session_list.insert(session);
+        asio::co_spawn(acceptor.get_executor(), read_loop(session), asio::detached);
+    }
+}
+
+asio::awaitable<void> network_manager::accept_udp_loop()
+{
+    std::array<char, 64> buffer;
+    while (true) {
+        ip::udp::endpoint udp_peer;
+        auto [ec, n] = co_await _udp_server->async_receive_from(asio::buffer(buffer), udp_peer);
+        if (ec) {
+            rt_log::info("{} {}", __func__, ec);
+            co_return;
+        }
+
+        if (n == sizeof(int)) {
+            int id = 0;
+            std::memcpy(&id, buffer.data(), sizeof(id));
+            fill_udp_peer(id, udp_peer);
+            continue;
+        }
+        if (n < sizeof(protocol::udp_msg_t)) {
+            continue;
+        }
+
+        protocol::udp_msg_t type;
+        std::memcpy(&type, buffer.data(), sizeof(type));
+        if (type == protocol::udp_msg_t::udp_msg_resume && n == sizeof(protocol::udp_resume_t)) {
+            protocol::udp_resume_t msg;
+            std::memcpy(&msg, buffer.data(), sizeof(msg));
+            resume_udp_peer(msg.token, udp_peer);
+        } else if (type == protocol::udp_msg_t::udp_msg_ping && n == sizeof(protocol::udp_ping_t)) {
+            protocol::udp_ping_t msg;
+            std::memcpy(&msg, buffer.data(), sizeof(msg));
+            handle_ping(msg, udp_peer);
+        } else if (type == protocol::udp_msg_t::udp_msg_report && n >= protocol::min_report_size && n <= sizeof(protocol::udp_report_t)) {
+            protocol::udp_report_t msg {};
+            std::memcpy(&msg, buffer.data(), n);
+            handle_report(msg, n, udp_peer);
+        } else {
+            rt_log::trace("{} unknown datagram type {} size {} udp://{}", __func__, (uint32_t)type, n, udp_peer);
+        }
+    }
+}
+
+// the kernel queues the tx timestamps on the socket error queue
+asio::awaitable<void> network_manager::tx_timestamp_loop()
+{
+    while (true) {
+        auto [ec] = co_await _udp_server->async_wait(ip::udp::socket::wait_error);
+        if (ec) {
+            rt_log::info("{} {}", __func__, ec);
+            co_return;
+        }
+
+        _tx_samples.clear();
+        if (!_tx_timestamper.drain(_udp_server->native_handle(), _tx_samples)) {
+            co_return;
+        }
+        for (auto& sample : _tx_samples) {
+            latency::get(latency::latency_wire).record(sample.delay);
+            auto slot = _playing_peer_list.find(sample.peer);
+            if (slot == playing_peer_list_t::npos) {
+                continue;
+            }
+            auto& wire_delay = _playing_peer_list.info(slot).wire_delay;
+            if (!wire_delay) {
+                wire_delay = std::make_shared<histogram>();
+            }
+            wire_delay->record(sample.delay);
+        }
+    }
+}
+
+#ifdef SIGUSR1
+// SIGUSR1 logs the latency histograms, SIGUSR2 dumps the flight recorder
+asio::awaitable<void> network_manager::signal_loop()
+{
+    signal_set signals(*_ioc, SIGUSR1, SIGUSR2);
+    while (true) {
+        auto [ec, signal] = co_await signals.async_wait();
+        if (ec) {
+            co_return;
+        }
+        if (signal == SIGUSR1) {
+            rt_log::info("latency\n{}", latency::report());
+        } else if (flight_recorder::enabled()) {
+            flight_recorder::trigger(flight_recorder::reason_signal);
+        }
+    }
+}
+#endif // SIGUSR1
+
+asio::awaitable<void> network_manager::accept_metrics_loop(tcp_acceptor acceptor)
+{
+    while (true) {
+        tcp_socket socket(acceptor.get_executor());
+        auto [ec] = co_await acceptor.async_accept(socket);
+        if (ec) {
+            rt_log::error("{} {}", __func__, ec);
+            co_return;
+        }
+        asio::co_spawn(acceptor.get_executor(), serve_metrics(std::move(socket)), asio::detached);
+    }
+}
+
+asio::awaitable<void> network_manager::serve_metrics(tcp_socket socket)
+{
+    // one request per connection, the body is rendered on the net thread so no state is shared
+    std::string request;
+    auto [ec, n] = co_await asio::async_read_until(socket, asio::dynamic_buffer(request, _max_metrics_request), "\r\n\r\n");
+    if (ec) {
+        rt_log::trace("{} {}", __func__, ec.message());
+        co_return;
+    }
+
+    std::string response;
+    if (request.starts_with("GET /metrics ") || request.starts_with("GET /metrics?")) {
+        auto body = render_metrics();
+        response = fmt::format("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}", body.size(), body);
+    } else {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+    co_await asio::async_write(socket, asio::buffer(response));
+    socket.shutdown(ip::tcp::socket::shutdown_send, ec);
+}
+
+std::string network_manager::render_metrics()
+{
+    std::string out;
+    metrics::append_counters(out);
+    latency::append_metrics(out);
+
+    size_t in_flight = 0;
+    for (auto count : _playing_peer_list.dense_in_flight()) {
+        in_flight += count;
+    }
+    metrics::append_metric(out, "audio_share_sessions", "gauge", "Connected TCP sessions.", (double)_session_list.size());
+    metrics::append_metric(out, "audio_share_playing_peers", "gauge", "Playing peers, parked ones included.", (double)_playing_peer_list.size());
+    metrics::append_metric(out, "audio_share_capture_active", "gauge", "1 while the capture runs.", _capture_active.load(std::memory_order_relaxed) ? 1 : 0);
+    metrics::append_metric(out, "audio_share_in_flight_datagrams", "gauge", "UDP sends not completed yet.", (double)(in_flight + _multicast_in_flight));
+    metrics::append_metric(out, "audio_share_playout_delay_seconds", "gauge", "Presentation time minus capture time of the synchronized clients.", _playout_delay_us / 1e6);
+    metrics::append_metric(out, "audio_share_capture_drift_ppm", "gauge", "Capture clock rate against the server clock, 0 until measured.", (_drift_estimator.ratio() - 1) * 1e6);
+
+    // one family per peer value, labeled with the peer id and its udp address
+    auto append_peer_metric = [&](const char* name, const char* type, const char* help, auto&& value) {
+        if (_playing_peer_list.empty()) {
+            return;
+        }
+        fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+        for (auto slot : _playing_peer_list.dense_slots()) {
+            const bool ready = _playing_peer_list.flags(slot) & playing_peer_list_t::flag_udp_ready;
+            fmt::format_to(std::back_inserter(out), "{}{{id=\"{}\",address=\"{}\"}} {}\n", name, _playing_peer_list.id(slot),
+                ready ? fmt::format("{}", _playing_peer_list.udp_peer(slot)) : std::string(), value(slot));
+        }
+    };
+    append_peer_metric("audio_share_peer_sent_bytes_total", "counter", "UDP bytes sent to the peer.", [&](auto slot) { return _playing_peer_list.info(slot).bytes_sent; });
+    append_peer_metric("audio_share_peer_sent_datagrams_total", "counter", "UDP datagrams sent to the peer.", [&](auto slot) { return _playing_peer_list.info(slot).datagrams_sent; });
+    append_peer_metric("audio_share_peer_send_errors_total", "counter", "UDP sends to the peer which failed.", [&](auto slot) { return _playing_peer_list.info(slot).send_failures; });
+    append_peer_metric("audio_share_peer_dropped_datagrams_total", "counter", "Datagrams dropped at the peer in-flight limit.", [&](auto slot) { return _playing_peer_list.info(slot).dropped; });
+    append_peer_metric("audio_share_peer_in_flight_datagrams", "gauge", "UDP sends to the peer not completed yet.", [&](auto slot) { return _playing_peer_list.in_flight(slot); });
+    append_peer_metric("audio_share_peer_rtt_seconds", "gauge", "Smoothed round trip time, 0 until measured.", [&](auto slot) { return _playing_peer_list.info(slot).clock.srtt_us() / 1e6; });
+    append_peer_metric("audio_share_peer_rtt_variation_seconds", "gauge", "Round trip time variation, 0 until measured.", [&](auto slot) { return _playing_peer_list.info(slot).clock.rttvar_us() / 1e6; });
+    append_peer_metric("audio_share_peer_one_way_delay_seconds", "gauge", "Estimated server to client delay, 0 until measured.", [&](auto slot) { return _playing_peer_list.info(slot).clock.one_way_delay_us() / 1e6; });
+    append_peer_metric("audio_share_peer_buffered_seconds", "gauge", "Audio buffered by the client, from its reports.", [&](auto slot) { return _playing_peer_list.info(slot).buffered_us / 1e6; });
+    append_peer_metric("audio_share_peer_stream_rate_ppm", "gauge", "Adaptive rate correction of the peer stream.", [&](auto slot) { return (_profile_list[_playing_peer_list.profile(slot)].ratio - 1) * 1e6; });
+    append_peer_metric("audio_share_peer_sync_error_seconds", "gauge", "Played minus presentation time reported by the client, 0 if it doesn't.", [&](auto slot) { return _playing_peer_list.info(slot).sync_error_us / 1e6; });
+    append_peer_metric("audio_share_peer_loss_ratio", "gauge", "Datagram loss of the last client report, 0 if it doesn't report it.", [&](auto slot) { return _playing_peer_list.info(slot).loss; });
+    append_peer_metric("audio_share_peer_bitrate_level", "gauge", "Adaptive bitrate step of the peer, 0 is the negotiated profile.", [&](auto slot) { return (double)_playing_peer_list.info(slot).ladder_level; });
+    append_peer_metric("audio_share_peer_clock_offset_seconds", "gauge", "Client clock minus server clock, 0 until measured.", [&](auto slot) { return _playing_peer_list.info(slot).clock.offset_us() / 1e6; });
+
+    if (_tx_timestamper.enabled()) {
+        metrics::append_metric(out, "audio_share_tx_timestamps_lost_total", "counter", "UDP sends whose kernel transmit timestamp never came back.", (double)_tx_timestamper.lost());
+        append_peer_metric("audio_share_peer_wire_delay_p50_seconds", "gauge", "Median time from the UDP send call to the wire.", [&](auto slot) {
+            auto& wire_delay = _playing_peer_list.info(slot).wire_delay;
+            return wire_delay ? wire_delay->snapshot().p50 / 1e9 : 0;
+        });
+        append_peer_metric("audio_share_peer_wire_delay_p99_seconds", "gauge", "99th percentile of the time from the UDP send call to the wire.", [&](auto slot) {
+            auto& wire_delay = _playing_peer_list.info(slot).wire_delay;
+            return wire_delay ? wire_delay->snapshot().p99 / 1e9 : 0;
+        });
+    }
+    return out;
+}
+
+asio::awaitable<void> network_manager::timer_loop()
+{
+    auto next_tick = std::chrono::steady_clock::now();
+    while (true) {
+        if (_timer_wheel.empty()) {
+            // sleep until schedule_heartbeat() cancels the wait
+            _wheel_timer->expires_at(std::chrono::steady_clock::time_point::max());
+            co_await _wheel_timer->async_wait();
+            next_tick = std::chrono::steady_clock::now() + _tick_interval;
+            continue;
+        }
+
+        _wheel_timer->expires_at(next_tick);
+        auto [ec] = co_await _wheel_timer->async_wait();
+        if (ec && ec != asio::error::operation_aborted) {
+            rt_log::error("{} {}", __func__, ec);
+            co_return;
+        }
+
+        // catch up with the ticks missed while the thread was busy
+        auto now = std::chrono::steady_clock::now();
+        while (next_tick <= now) {
+            _timer_wheel.advance([this](int id) { on_heartbeat_timer(id); });
+            next_tick += _tick_interval;
+            if (_timer_wheel.now() % _stats_ticks == 0) {
+                auto stats = handler_memory::stats();
+                rt_log::trace("handler memory allocations:{} heap:{} remote frees:{} in use:{}", stats.allocations, stats.heap_allocations, stats.remote_frees, stats.in_use);
+                if (spdlog::should_log(spdlog::level::trace)) {
+                    rt_log::trace("latency\n{}", latency::report());
+                }
+            }
+        }
+    }
+}
+
+void network_manager::schedule_heartbeat(int id)
+{
+    bool idle = _timer_wheel.empty();
+    _timer_wheel.schedule(id, _heartbeat_interval / _tick_interval);
+    if (idle && _wheel_timer) {
+        _wheel_timer->cancel();
+    }
+}
+
+void network_manager::on_heartbeat_timer(int id)
+{
+    auto slot = _playing_peer_list.find(id);
+    if (slot == playing_peer_list_t::npos) {
+        // the peer is gone, drop the stale timer
+        return;
+    }
+
+    auto session = _playing_peer_list.connection(slot);
+    const auto& info = _playing_peer_list.info(slot);
+    const auto now = std::chrono::steady_clock::now();
+    if (!session->socket.is_open()) {
+        // parked, or resumed over udp and kept alive by its resume datagrams
+        if (now - info.last_tick > (info.parked ? _resume_grace : _heartbeat_timeout)) {
+            rt_log::info("id:{} resume timeout", id);
+            AUDIO_SHARE_PROBE1(heartbeat_timeout, id);
+            metrics::add(metrics::counter_heartbeat_timeouts);
+            flight_recorder::record(flight_recorder::event_timeout, id);
+            drop_peer(session);
+            return;
+        }
+        schedule_heartbeat(id);
+        return;
+    }
+
+    // a pinging client is known alive, spare it the tcp round trip
+    if (now - info.last_ping <= _heartbeat_interval) {
+        schedule_heartbeat(id);
+        return;
+    }
+
+    if (now - info.last_tick > _heartbeat_timeout) {
+        rt_log::info("{} timeout", session->remote_endpoint);
+        AUDIO_SHARE_PROBE1(heartbeat_timeout, id);
+        metrics::add(metrics::counter_heartbeat_timeouts);
+        flight_recorder::record(flight_recorder::event_timeout, id);
+        close_session(session);
+        if (_playing_peer_list.find(id) != playing_peer_list_t::npos) {
+            // parked, keep the timer for the grace period
+            schedule_heartbeat(id);
+        }
+        return;
+    }
+
+    // all heartbeats due in this tick are queued back to back without waiting for each other
+    std::string heartbeat;
+    protocol::append_cmd(heartbeat, cmd_t::cmd_heartbeat);
+    send(session, heartbeat);
+    schedule_heartbeat(id);
+}
+
+void network_manager::push_format()
+{
+    _capture_format = _audio_manager->get_format();
+    auto version = _capture_format.version();
+    flight_recorder::record(flight_recorder::event_format_changed, version, _capture_format.sample_rate());
+    _last_fanout = {};
+
+    const size_t frame_size = sample_format::bytes_per_sample(_capture_format.encoding()) * _capture_format.channels();
+    const size_t frames_per_packet = ((uint64_t)_capture_format.sample_rate() * _packet_duration_us + 500000) / 1000000;
+    _reframer.reset(frame_size, frames_per_packet);
+    _capture_format.set_frames_per_packet((uint32_t)frames_per_packet);
+    _drift_estimator.reset(_capture_format.sample_rate());
+    _last_clock_report = {};
+
+    for (size_t i = 0; i < _profile_list.size(); ++i) {
+        _profile_list[i].discontinuity = true;
+        clear_history(_profile_list[i]);
+        const int channels = _profile_list[i].profile.mono ? 1 : _capture_format.channels();
+        _profile_list[i].rate_converter.reset(channels);
+        _profile_list[i].half_rate_filter.reset(channels);
+        update_format_binary((uint8_t)i);
+    }
+
+    // one frame per profile, built on first use
+    std::vector<std::string> frame_list(_profile_list.size());
+    int count = 0;
+    for (auto& session : _session_list) {
+        if (!session->format_push || session->format_version == version) {
+            continue;
+        }
+        auto& frame = frame_list[session->profile];
+        if (frame.empty()) {
+            protocol::append_frame(frame, cmd_t::cmd_format_changed, _profile_list[session->profile].format_binary);
+        }
+        session->format_version = version;
+        send(session, frame);
+        ++count;
+    }
+    rt_log::info("{} version:{} frames per packet:{} sessions:{}", __func__, version, frames_per_packet, count);
+}
+
+void network_manager::update_format_binary(uint8_t profile)
+{
+    auto& entry = _profile_list[profile];
+    entry.format_binary = entry.profile.make_format(_capture_format).SerializeAsString();
+}
+
+uint8_t network_manager::acquire_profile(const output_profile_t& profile)
+{
+    size_t free_index = 0;
+    for (size_t i = 0; i < _profile_list.size(); ++i) {
+        auto& entry = _profile_list[i];
+        if ((i == 0 || entry.sessions > 0) && entry.profile == profile) {
+            ++entry.sessions;
+            return (uint8_t)i;
+        }
+        if (i != 0 && entry.sessions == 0 && free_index == 0) {
+            free_index = i;
+        }
+    }
+
+    if (free_index == 0) {
+        if (_profile_list.size() > UINT8_MAX) {
+            rt_log::error("{} too many profiles, use the native one", __func__);
+            ++_profile_list[0].sessions;
+            return 0;
+        }
+        free_index = _profile_list.size();
+        _profile_list.emplace_back();
+    }
+
+    // a reused entry starts over
+    auto& entry = _profile_list[free_index];
+    entry = {};
+    entry.profile = profile;
+    entry.sessions = 1;
+    reset_rate(entry);
+    update_format_binary((uint8_t)free_index);
+    return (uint8_t)free_index;
+}
+
+void network_manager::release_profile(uint8_t profile)
+{
+    auto& entry = _profile_list[profile];
+    if (--entry.sessions == 0 && profile != 0) {
+        entry.converted = {};
+    }
+}
+
+void network_manager::close_session(const std::shared_ptr<session_t>& session)
+{
+    if (!session->socket.is_open()) {
+        return;
+    }
+
+    rt_log::info("close {}", session->remote_endpoint);
+    _session_list.erase(session);
+    asio::error_code ec;
+    session->socket.shutdown(ip::tcp::socket::shutdown_both, ec);
+    session->socket.close(ec);
+
+    auto slot = _playing_peer_list.find(session.get());
+    if (slot != playing_peer_list_t::npos && _playing_peer_list.info(slot).token != 0) {
+        // keep playing over udp for the grace period, the client may come back with its token
+        auto& info = _playing_peer_list.info(slot);
+        info.parked = true;
+        info.last_tick = std::chrono::steady_clock::now();
+        rt_log::info("park id:{}", _playing_peer_list.id(slot));
+        return;
+    }
+    drop_peer(session);
+}
+
+void network_manager::drop_peer(const std::shared_ptr<session_t>& session)
+{
+    remove_playing_peer(session);
+    if (session->hello) {
+        release_profile(session->profile);
+        session->hello = false;
+    }
+}
+
+int network_manager::add_playing_peer(const std::shared_ptr<session_t>& session)
+{
+    static int g_id = 0;
+    auto id = ++g_id;
+    auto slot = _playing_peer_list.add(session, id);
+    if (slot == playing_peer_list_t::npos) {
+        rt_log::error("{} repeat add tcp://{}", __func__, session->remote_endpoint);
+        return 0;
+    }
+
+    _playing_peer_list.info(slot).last_tick = std::chrono::steady_clock::now();
+    _playing_peer_list.set_profile(slot, session->profile);
+    auto& entry = _profile_list[session->profile];
+    if (entry.playing++ == 0) {
+        // what is left from the last playback is stale
+        entry.discontinuity = true;
+        clear_history(entry);
+        reset_rate(entry);
+    }
+    if (_playing_peer_list.size() == 1) {
+        set_capture_active(true);
+    }
+    schedule_heartbeat(id);
+
+    AUDIO_SHARE_PROBE1(peer_add, id);
+    rt_log::trace("{} add id:{} tcp://{}", __func__, id, session->remote_endpoint);
+    return id;
+}
+
+void network_manager::remove_playing_peer(const std::shared_ptr<session_t>& session)
+{
+    auto slot = _playing_peer_list.find(session.get());
+    if (slot == playing_peer_list_t::npos) {
+        rt_log::trace("{} not playing tcp://{}", __func__, session->remote_endpoint);
+        return;
+    }
+
+    const auto dropped = _playing_peer_list.info(slot).dropped;
+    AUDIO_SHARE_PROBE1(peer_remove, _playing_peer_list.id(slot));
+    --_profile_list[_playing_peer_list.profile(slot)].playing;
+    _token_index.erase(_playing_peer_list.info(slot).token);
+    _playing_peer_list.remove(slot);
+    if (_playing_peer_list.empty()) {
+        set_capture_active(false);
+    }
+    rt_log::trace("{} remove tcp://{} dropped datagrams:{}", __func__, session->remote_endpoint, dropped);
+}
+
+void network_manager::fill_udp_peer(int id, asio::ip::udp::endpoint udp_peer)
+{
+    auto slot = _playing_peer_list.find(id);
+    if (slot == playing_peer_list_t::npos) {
+        rt_log::error("{} no tcp peer id:{} udp://{}", __func__, id, udp_peer);
+        return;
+    }
+    // the id is easy to guess, only the token can move an address already known
+    if ((_playing_peer_list.flags(slot) & playing_peer_list_t::flag_udp_ready) && _playing_peer_list.udp_peer(slot) != udp_peer) {
+        rt_log::warn("{} id:{} already bound, ignore udp://{}", __func__, id, udp_peer);
+        return;
+    }
+
+    attach_udp_peer(slot, udp_peer);
+    rt_log::info("{} fill udp peer id:{} tcp://{} udp://{}", __func__, id, _playing_peer_list.connection(slot)->remote_endpoint, udp_peer);
+}
+
+void network_manager::resume_udp_peer(uint64_t token, asio::ip::udp::endpoint udp_peer)
+{
+    auto it = _token_index.find(token);
+    if (it == _token_index.end()) {
+        rt_log::trace("{} unknown token udp://{}", __func__, udp_peer);
+        return;
+    }
+
+    auto slot = _playing_peer_list.find(it->second);
+    auto& info = _playing_peer_list.info(slot);
+    if (info.parked) {
+        rt_log::info("{} id:{} udp://{}", __func__, it->second, udp_peer);
+    }
+    info.parked = false;
+    info.last_tick = std::chrono::steady_clock::now();
+    attach_udp_peer(slot, udp_peer);
+}
+
+void network_manager::handle_ping(const protocol::udp_ping_t& ping, asio::ip::udp::endpoint udp_peer)
+{
+    auto it = _token_index.find(ping.token);
+    if (it == _token_index.end()) {
+        rt_log::trace("{} unknown token udp://{}", __func__, udp_peer);
+        return;
+    }
+
+    const auto slot = _playing_peer_list.find(it->second);
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    auto& info = _playing_peer_list.info(slot);
+    info.parked = false;
+    info.last_tick = now;
+    info.last_ping = now;
+    info.last_sequence = ping.last_sequence;
+
+    if (ping.echo_time_us != 0) {
+        // the pong was received at client time - echo delay and the ping sent at client time
+        info.clock.update((int64_t)ping.echo_time_us, (int64_t)(ping.client_time_us - ping.echo_delay_us), (int64_t)ping.client_time_us, (int64_t)now_us);
+    }
+    rt_log::trace("{} id:{} last sequence:{} srtt:{}us rttvar:{}us offset:{}us one way delay:{}us", __func__, it->second, ping.last_sequence,
+        info.clock.srtt_us(), info.clock.rttvar_us(), info.clock.offset_us(), info.clock.one_way_delay_us());
+
+    // follows nat rebinding too
+    attach_udp_peer(slot, udp_peer);
+
+    if (_profile_list[_playing_peer_list.profile(slot)].profile.packet_header) {
+        auto datagram = std::allocate_shared<datagram_t>(handler_allocator<datagram_t>(), sizeof(protocol::packet_header_t) + sizeof(protocol::udp_pong_t));
+        protocol::packet_header_t header {
+            .sequence = 0,
+            .flags = protocol::packet_header_t::flag_control,
+            .frame_position = 0,
+        };
+        protocol::udp_pong_t pong {
+            .type = protocol::udp_msg_t::udp_msg_ping,
+            .client_time_us = ping.client_time_us,
+            .server_time_us = now_us,
+        };
+        std::memcpy(datagram->data(), &header, sizeof(header));
+        std::memcpy(datagram->data() + sizeof(header), &pong, sizeof(pong));
+        send_to_peer(slot, datagram);
+    }
+}
+
+void network_manager::handle_report(const protocol::udp_report_t& report, size_t size, asio::ip::udp::endpoint udp_peer)
+{
+    auto it = _token_index.find(report.token);
+    if (it == _token_index.end()) {
+        rt_log::trace("{} unknown token udp://{}", __func__, udp_peer);
+        return;
+    }
+
+    const auto slot = _playing_peer_list.find(it->second);
+    const auto now = std::chrono::steady_clock::now();
+    auto& info = _playing_peer_list.info(slot);
+    info.parked = false;
+    info.last_tick = now;
+    // the fill swings by a packet between two arrivals
+    info.buffered_us = info.last_report == std::chrono::steady_clock::time_point {} ? report.buffered_us : (uint32_t)(((uint64_t)info.buffered_us * 3 + report.buffered_us) / 4);
+    info.target_us = report.target_us ? report.target_us : _playing_peer_list.connection(slot)->jitter_buffer_ms * 1000;
+    info.last_report = now;
+    info.has_sync_error = size >= offsetof(protocol::udp_report_t, sync_error_us) + sizeof(report.sync_error_us);
+    info.sync_error_us = info.has_sync_error ? report.sync_error_us : 0;
+    rt_log::trace("{} id:{} buffered:{}us target:{}us sync error:{}us", __func__, it->second, info.buffered_us, info.target_us, info.sync_error_us);
+
+    const auto profile = _playing_peer_list.profile(slot);
+    if (_profile_list[profile].profile.adaptive_rate) {
+        update_rate(profile);
+    }
+    if (size >= sizeof(protocol::udp_report_t) && _playing_peer_list.connection(slot)->adaptive_bitrate) {
+        adapt_bitrate(slot, report);
+    }
+}
+
+void network_manager::adapt_bitrate(playing_peer_list_t::slot_t slot, const protocol::udp_report_t& report)
+{
+    auto& info = _playing_peer_list.info(slot);
+    if (report.packets_expected == 0) {
+        return;
+    }
+    info.loss = std::min((double)report.packets_lost / report.packets_expected, 1.0);
+    info.delay_trend_us = report.delay_trend_us;
+
+    // the format change goes over tcp, and a burst would mix two formats
+    const auto& session = _playing_peer_list.connection(slot);
+    if (!session->socket.is_open() || _playing_peer_list.flags(slot) & playing_peer_list_t::flag_catching_up) {
+        return;
+    }
+    if (info.ladder.empty()) {
+        info.ladder = _profile_list[session->profile].profile.ladder(_capture_format);
+    }
+
+    const bool congested = info.loss > _abr_loss_high || info.delay_trend_us > _abr_trend_high_us;
+    const bool clear = info.loss < _abr_loss_low && info.delay_trend_us < _abr_trend_low_us;
+    info.congested_reports = congested ? info.congested_reports + 1 : 0;
+    info.clear_reports = clear ? info.clear_reports + 1 : 0;
+
+    // down fast, up slowly, so a flapping link settles on the lower step
+    const auto now = std::chrono::steady_clock::now();
+    size_t level = info.ladder_level;
+    if (info.congested_reports >= _abr_down_reports && level + 1 < info.ladder.size()) {
+        ++level;
+    } else if (info.clear_reports >= _abr_up_reports && level > 0 && now - info.last_switch >= _abr_up_hold) {
+        --level;
+        if (_max_bandwidth) {
+            const auto& current = _profile_list[session->profile].profile;
+            const uint64_t bandwidth = used_bandwidth() - admission::stream_bitrate(_capture_format, current)
+                + admission::stream_bitrate(_capture_format, info.ladder[level]);
+            if (bandwidth > _max_bandwidth) {
+                info.clear_reports = 0;
+                return;
+            }
+        }
+    }
+    if (level == info.ladder_level) {
+        return;
+    }
+
+    rt_log::info("{} id:{} level:{} -> {} loss:{:.1f}% delay trend:{}us", __func__, _playing_peer_list.id(slot), info.ladder_level, level,
+        info.loss * 100, info.delay_trend_us);
+    switch_profile(slot, info.ladder[level]);
+    info.ladder_level = level;
+    info.congested_reports = 0;
+    info.clear_reports = 0;
+    info.last_switch = now;
+}
+
+void network_manager::switch_profile(playing_peer_list_t::slot_t slot, const output_profile_t& profile)
+{
+    const auto session = _playing_peer_list.connection(slot);
+    const auto old_profile = session->profile;
+    const auto new_profile = acquire_profile(profile);
+    auto& entry = _profile_list[new_profile];
+    if (entry.playing++ == 0) {
+        entry.discontinuity = true;
+        clear_history(entry);
+        reset_rate(entry);
+    }
+    --_profile_list[old_profile].playing;
+    release_profile(old_profile);
+    session->profile = new_profile;
+    session->format_version = _capture_format.version();
+    _playing_peer_list.set_profile(slot, new_profile);
+
+    std::string frame;
+    protocol::append_frame(frame, cmd_t::cmd_format_changed, entry.format_binary);
+    send(session, frame);
+}
+
+void network_manager::update_rate(uint8_t profile)
+{
+    // a stream shared by several clients follows their mean error
+    const auto now = std::chrono::steady_clock::now();
+    double error_ms = 0;
+    int count = 0;
+    for (auto slot : _playing_peer_list.dense_slots()) {
+        const auto& info = _playing_peer_list.info(slot);
+        if (_playing_peer_list.profile(slot) != profile || info.target_us == 0 || now - info.last_report > _report_timeout) {
+            continue;
+        }
+        error_ms += ((double)info.buffered_us - info.target_us) / 1000;
+        ++count;
+    }
+    if (count == 0) {
+        return;
+    }
+    error_ms /= count;
+
+    // a buffer fuller than the target means the client plays slower than the capture: send fewer frames
+    auto& entry = _profile_list[profile];
+    if (entry.last_rate_update != std::chrono::steady_clock::time_point {}) {
+        const double elapsed = std::min(std::chrono::duration<double>(now - entry.last_rate_update).count(), 2.0);
+        const double max_integral = _max_rate_ppm / _rate_ki;
+        entry.rate_integral = std::clamp(entry.rate_integral + error_ms * elapsed, -max_integral, max_integral);
+    }
+    entry.last_rate_update = now;
+    const double ppm = std::clamp(_rate_kp * error_ms + _rate_ki * entry.rate_integral, -_max_rate_ppm, _max_rate_ppm);
+    entry.ratio = 1 - ppm / 1e6;
+}
+
+void network_manager::reset_rate(profile_entry_t& entry)
+{
+    const int channels = entry.profile.mono ? 1 : _capture_format.channels();
+    entry.rate_converter.reset(channels);
+    entry.half_rate_filter.reset(channels);
+    entry.ratio = 1;
+    entry.rate_integral = 0;
+    entry.last_rate_update = {};
+    entry.frame_position = _frame_position;
+}
+
+void network_manager::send_clock_report()
+{
+    // the anchor is the first frame of the quantum, the reframer holds the frames before it
+    const uint64_t pending = _reframer.pending_frames();
+    const double capture_ratio = _drift_estimator.ratio();
+    for (size_t i = 0; i < _profile_list.size(); ++i) {
+        const auto& entry = _profile_list[i];
+        if (entry.playing <= 0 || !entry.profile.packet_header) {
+            continue;
+        }
+
+        auto datagram = std::allocate_shared<datagram_t>(handler_allocator<datagram_t>(), sizeof(protocol::packet_header_t) + sizeof(protocol::udp_clock_t));
+        protocol::packet_header_t header {
+            .sequence = 0,
+            .flags = protocol::packet_header_t::flag_control,
+            .frame_position = 0,
+        };
+        protocol::udp_clock_t clock {
+            .type = protocol::udp_msg_t::udp_msg_clock,
+            .frame_position = entry.profile.float_path() ? entry.frame_position + (uint64_t)std::llround(pending * entry.ratio / (entry.profile.half_rate ? 2 : 1)) : _anchor_position,
+            .server_time_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(_anchor_time.time_since_epoch()).count(),
+            .drift_ppb = (int32_t)std::lround((capture_ratio * entry.ratio - 1) * 1e9),
+            .playout_delay_us = _playout_delay_us,
+        };
+        std::memcpy(datagram->data(), &header, sizeof(header));
+        std::memcpy(datagram->data() + sizeof(header), &clock, sizeof(clock));
+        send_datagram((uint8_t)i, datagram);
+    }
+}
+
+void network_manager::update_playout_delay(std::chrono::steady_clock::time_point now)
+{
+    if (_playout_delay_config_us) {
+        return;
+    }
+
+    // the farthest synchronized client sets the delay of all, it never shrinks while they play
+    bool synchronized = false;
+    int64_t path_us = 0;
+    for (auto slot : _playing_peer_list.dense_slots()) {
+        if (!_profile_list[_playing_peer_list.profile(slot)].profile.presentation_time) {
+            continue;
+        }
+        synchronized = true;
+        const auto& clock = _playing_peer_list.info(slot).clock;
+        if (clock.measured()) {
+            path_us = std::max<int64_t>(path_us, clock.one_way_delay_us() + 4 * (int64_t)clock.rttvar_us());
+        }
+    }
+    const int64_t min_us = std::chrono::microseconds(_min_playout_delay).count();
+    if (!synchronized) {
+        _playout_delay_us = (uint32_t)min_us;
+        return;
+    }
+
+    // plus the way from the capture to the fan-out
+    const int64_t capture_us = std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - _anchor_time).count(), 0);
+    const int64_t delay_us = path_us + capture_us + std::chrono::microseconds(_playout_margin).count();
+    const auto delay = (uint32_t)std::clamp<int64_t>(delay_us, min_us, UINT32_MAX);
+    if (delay > _playout_delay_us) {
+        rt_log::info("{} {}us", __func__, delay);
+        _playout_delay_us = delay;
+    }
+}
+
+uint64_t network_manager::presentation_time_us(double capture_position) const
+{
+    const double frame_us = 1e6 / (std::max(_capture_format.sample_rate(), 1) * _drift_estimator.ratio());
+    const double anchor_us = (double)std::chrono::duration_cast<std::chrono::microseconds>(_anchor_time.time_since_epoch()).count();
+    return (uint64_t)std::llround(anchor_us + (capture_position - (double)_anchor_position) * frame_us) + _playout_delay_us;
+}
+
+void network_manager::attach_udp_peer(playing_peer_list_t::slot_t slot, const asio::ip::udp::endpoint& udp_peer)
+{
+    const auto flags = _playing_peer_list.flags(slot);
+    const bool moved = !(flags & playing_peer_list_t::flag_udp_ready) || _playing_peer_list.udp_peer(slot) != udp_peer;
+    _playing_peer_list.set_udp_peer(slot, udp_peer);
+
+    // a new or roaming peer gets the prebuffer to refill its jitter buffer
+    if (moved && !(flags & playing_peer_list_t::flag_catching_up) && !_profile_list[_playing_peer_list.profile(slot)].history.empty()) {
+        _playing_peer_list.set_flags(slot, playing_peer_list_t::flag_catching_up);
+        asio::co_spawn(*_ioc, prebuffer_burst(_playing_peer_list.id(slot)), asio::detached);
+    }
+}
+
+void network_manager::broadcast_audio_data(const char* data, size_t count, int block_align, const clock_reading_t& clock)
+{
+    if (count <= 0 || !_capture_active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // rt_log::trace("broadcast_audio_data count: {}", count);
+    metrics::add(metrics::counter_capture_quanta);
+    flight_recorder::record(flight_recorder::event_capture, (uint32_t)count, block_align ? count / block_align : 0);
+
+    // conversion and segmentation are done per profile on the net thread
+    auto quantum = std::allocate_shared<datagram_t>(handler_allocator<datagram_t>(), (const uint8_t*)data, (const uint8_t*)data + count);
+    asio::post(*_ioc, asio::bind_allocator(handler_allocator<void>(), [quantum = std::move(quantum), block_align, clock, posted = std::chrono::steady_clock::now(), self = shared_from_this()] {
+        latency::record(latency::latency_post, posted);
+        const int capture_block_align = sample_format::bytes_per_sample(self->_capture_format.encoding()) * self->_capture_format.channels();
+        if (block_align != capture_block_align) {
+            // the format change has not reached the net thread yet
+            rt_log::trace("broadcast_audio_data block align {} != {}", block_align, capture_block_align);
+            return;
+        }
+        if (self->_resume_time != std::chrono::steady_clock::time_point {}) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - self->_resume_time);
+            rt_log::info("capture resumed in {}us", elapsed.count());
+            self->_resume_time = {};
+        }
+        auto fanout_begin = std::chrono::steady_clock::now();
+        self->detect_send_gap(fanout_begin, quantum->size() / capture_block_align);
+        self->_drift_estimator.update(clock);
+        // without a clock from the backend, the last frame of the quantum has just been captured
+        const size_t quantum_frames = quantum->size() / capture_block_align;
+        self->_anchor_position = self->_frame_position + self->_reframer.pending_frames();
+        self->_anchor_time = clock.time != std::chrono::steady_clock::time_point {}
+            ? self->_drift_estimator.time_of(clock.position)
+            : fanout_begin - std::chrono::nanoseconds((uint64_t)quantum_frames * 1000000000 / std::max(self->_capture_format.sample_rate(), 1));
+        if (fanout_begin - self->_last_clock_report >= _clock_report_interval) {
+            self->_last_clock_report = fanout_begin;
+            self->update_playout_delay(fanout_begin);
+            self->send_clock_report();
+        }
+        uint32_t packets = 0;
+        self->_reframer.push(*quantum, [&](std::span<const uint8_t> packet) {
+            self->send_audio_data(packet);
+            ++packets;
+        });
+        latency::record(latency::latency_fanout, fanout_begin);
+        flight_recorder::record(flight_recorder::event_fanout, packets, (std::chrono::steady_clock::now() - fanout_begin).count());
+    }));
+}
+
+void network_manager::detect_send_gap(std::chrono::steady_clock::time_point now, size_t frames)
+{
+    // a fan-out more than 2 quanta after the last one means the stream stalled somewhere before us
+    if (_last_fanout != std::chrono::steady_clock::time_point {} && _last_quantum.count() && now - _last_fanout > 2 * _last_quantum) {
+        auto gap = std::chrono::duration_cast<std::chrono::microseconds>(now - _last_fanout);
+        auto quantum = std::chrono::duration_cast<std::chrono::microseconds>(_last_quantum);
+        flight_recorder::record(flight_recorder::event_send_gap, (uint32_t)gap.count(), quantum.count());
+        flight_recorder::trigger(flight_recorder::reason_send_gap);
+    }
+    _last_fanout = now;
+    _last_quantum = std::chrono::nanoseconds((uint64_t)frames * 1000000000 / std::max(_capture_format.sample_rate(), 1));
+}
+
+void network_manager::send_audio_data(std::span<const uint8_t> data)
+{
+    const auto capture_encoding = _capture_format.encoding();
+    const int channels = _capture_format.channels();
+    const size_t frames = data.size() / (sample_format::bytes_per_sample(capture_encoding) * channels);
+    const size_t samples = frames * channels;
+
+    for (size_t i = 0; i < _profile_list.size(); ++i) {
+        auto& entry = _profile_list[i];
+        if (entry.playing <= 0) {
+            continue;
+        }
+
+        const auto& profile = entry.profile;
+        const auto encoding = profile.select_encoding(capture_encoding);
+        const int out_channels = profile.mono ? 1 : channels;
+        const size_t block_align = sample_format::bytes_per_sample(encoding) * out_channels;
+
+        const uint8_t* pcm = data.data();
+        size_t pcm_frames = frames;
+        uint64_t position = _frame_position;
+        if (profile.float_path()) {
+            // downmix, resample and decimate work on float whatever the encodings
+            constexpr auto float_encoding = pb::AudioFormat_Encoding_ENCODING_PCM_FLOAT;
+            entry.resample_in.resize(samples);
+            sample_format::convert(data.data(), capture_encoding, entry.resample_in.data(), float_encoding, samples);
+            std::span<const float> pcm_float = entry.resample_in;
+            if (profile.mono) {
+                entry.downmixed.resize(frames);
+                for (size_t f = 0; f < frames; ++f) {
+                    float sum = 0;
+                    for (int c = 0; c < channels; ++c) {
+                        sum += entry.resample_in[f * channels + c];
+                    }
+                    entry.downmixed[f] = sum / channels;
+                }
+                pcm_float = entry.downmixed;
+            }
+            if (profile.adaptive_rate) {
+                entry.resample_out.clear();
+                entry.rate_converter.process(pcm_float, entry.ratio, entry.resample_out);
+                pcm_float = entry.resample_out;
+            }
+            if (profile.half_rate) {
+                entry.decimated.clear();
+                entry.half_rate_filter.process(pcm_float, entry.decimated);
+                pcm_float = entry.decimated;
+            }
+            pcm_frames = pcm_float.size() / out_channels;
+            entry.converted.resize(pcm_frames * block_align);
+            sample_format::convert(pcm_float.data(), float_encoding, entry.converted.data(), encoding, pcm_frames * out_channels);
+            pcm = entry.converted.data();
+            position = entry.frame_position;
+            entry.frame_position += pcm_frames;
+        } else if (encoding != capture_encoding) {
+            entry.converted.resize(samples * sample_format::bytes_per_sample(encoding));
+            sample_format::convert(data.data(), capture_encoding, entry.converted.data(), encoding, samples);
+            pcm = entry.converted.data();
+        }
+        const size_t pcm_size = pcm_frames * block_align;
+
+        // divide udp frame
+        const size_t header_size = (profile.packet_header ? sizeof(protocol::packet_header_t) : 0) + (profile.presentation_time ? sizeof(uint64_t) : 0);
+        size_t max_seg_size = profile.max_payload_size - header_size;
+        max_seg_size -= max_seg_size % block_align; // one single sample can't be divided
+        if (max_seg_size == 0) {
+            continue;
+        }
+        AUDIO_SHARE_PROBE3(segment, i, pcm_size, (pcm_size + max_seg_size - 1) / max_seg_size);
+
+        for (size_t begin_pos = 0; begin_pos < pcm_size;) {
+            const size_t real_seg_size = std::min(pcm_size - begin_pos, max_seg_size);
+            auto datagram = std::allocate_shared<datagram_t>(handler_allocator<datagram_t>(), header_size + real_seg_size);
+            if (profile.packet_header) {
+                protocol::packet_header_t header {
+                    .sequence = entry.sequence++,
+                    .flags = entry.discontinuity ? protocol::packet_header_t::flag_discontinuity : protocol::packet_header_t::flag_none,
+                    .frame_position = position + begin_pos / block_align,
+                };
+                if (profile.presentation_time) {
+                    // a resampled frame covers 1 / ratio capture frames, a decimated one 2
+                    const double capture_frames = (double)(begin_pos / block_align) * (profile.half_rate ? 2 : 1) / (profile.adaptive_rate ? entry.ratio : 1);
+                    const uint64_t presentation_time = presentation_time_us((double)_frame_position + capture_frames);
+                    header.flags |= protocol::packet_header_t::flag_presentation_time;
+                    std::memcpy(datagram->data() + sizeof(header), &presentation_time, sizeof(presentation_time));
+                }
+                std::memcpy(datagram->data(), &header, sizeof(header));
+            }
+            entry.discontinuity = false;
+            std::copy(pcm + begin_pos, pcm + begin_pos + real_seg_size, datagram->begin() + header_size);
+            send_datagram((uint8_t)i, datagram);
+            begin_pos += real_seg_size;
+
+            if (_prebuffer_ms && !profile.multicast) {
+                entry.history.push_back({ datagram, (uint32_t)(real_seg_size / block_align) });
+                entry.history_frames += entry.history.back().frames;
+                const uint64_t max_frames = (uint64_t)_capture_format.sample_rate() / (profile.half_rate ? 2 : 1) * _prebuffer_ms / 1000;
+                while (entry.history.size() > 1 && entry.history_frames - entry.history.front().frames >= max_frames) {
+                    entry.history_frames -= entry.history.front().frames;
+                    entry.history.pop_front();
+                    ++entry.history_base;
+                }
+            }
+        }
+    }
+
+    _frame_position += frames;
+}
+
+void network_manager::send_datagram(uint8_t profile, const datagram_ptr& datagram)
+{
+    if (_profile_list[profile].profile.multicast) {
+        if (_multicast_in_flight >= _max_in_flight) {
+            metrics::add(metrics::counter_dropped_datagrams);
+            flight_recorder::record(flight_recorder::event_drop, 0, _multicast_in_flight);
+            flight_recorder::trigger(flight_recorder::reason_overrun);
+            return;
+        }
+        ++_multicast_in_flight;
+        AUDIO_SHARE_PROBE2(send, 0, datagram->size());
+        _udp_server->async_send_to(asio::buffer(*datagram), _multicast_endpoint, asio::bind_allocator(handler_allocator<void>(), [self = shared_from_this(), datagram, begin = std::chrono::steady_clock::now(), ticket = _tx_timestamper.sent(0)](const asio::error_code& ec, std::size_t bytes_transferred) {
+            latency::record(latency::latency_send, begin);
+            AUDIO_SHARE_PROBE2(send_done, 0, ec.value());
+            --self->_multicast_in_flight;
+            if (ec) {
+                self->_tx_timestamper.failed(ticket);
+                metrics::add(metrics::counter_send_errors);
+                flight_recorder::record(flight_recorder::event_send_error, 0, (uint64_t)ec.value());
+                rt_log::trace("multicast send {}", ec.message());
+                return;
+            }
+            metrics::add(metrics::counter_bytes_sent, bytes_transferred);
+            metrics::add(metrics::counter_datagrams_sent);
+            flight_recorder::record(flight_recorder::event_send, 0, bytes_transferred);
+        }));
+        return;
+    }
+
+    // one linear pass over the packed fan-out data, the slot is looked up only for a peer at its limit
+    const auto udp_peers = _playing_peer_list.udp_peers();
+    const auto flags = _playing_peer_list.dense_flags();
+    const auto profiles = _playing_peer_list.dense_profiles();
+    const auto ids = _playing_peer_list.dense_ids();
+    auto in_flight = _playing_peer_list.dense_in_flight();
+    for (size_t i = 0; i < flags.size(); ++i) {
+        if ((flags[i] & (playing_peer_list_t::flag_udp_ready | playing_peer_list_t::flag_catching_up)) != playing_peer_list_t::flag_udp_ready || profiles[i] != profile) {
+            continue;
+        }
+        if (in_flight[i] >= _max_in_flight) {
+            send_to_peer(_playing_peer_list.dense_slots()[i], datagram);
+            continue;
+        }
+        ++in_flight[i];
+        start_send(ids[i], udp_peers[i], datagram);
+    }
+}
+
+void network_manager::send_to_peer(playing_peer_list_t::slot_t slot, const datagram_ptr& datagram)
+{
+    auto& in_flight = _playing_peer_list.in_flight(slot);
+    if (in_flight >= _max_in_flight) {
+        // the sends in flight are already with the kernel, a slow peer gets the newest audio when it recovers
+        ++_playing_peer_list.info(slot).dropped;
+        metrics::add(metrics::counter_dropped_datagrams);
+        flight_recorder::record(flight_recorder::event_drop, _playing_peer_list.id(slot), in_flight);
+        flight_recorder::trigger(flight_recorder::reason_overrun);
+        return;
+    }
+
+    ++in_flight;
+    start_send(_playing_peer_list.id(slot), _playing_peer_list.udp_peer(slot), datagram);
+}
+
+void network_manager::start_send(int id, const asio::ip::udp::endpoint& udp_peer, const datagram_ptr& datagram)
+{
+    // the completion never runs inline, the caller may keep iterating the registry
+    AUDIO_SHARE_PROBE2(send, id, datagram->size());
+    _udp_server->async_send_to(asio::buffer(*datagram), udp_peer, asio::bind_allocator(handler_allocator<void>(), [self = shared_from_this(), id, datagram, begin = std::chrono::steady_clock::now(), ticket = _tx_timestamper.sent(id)](const asio::error_code& ec, std::size_t bytes_transferred) {
+        latency::record(latency::latency_send, begin);
+        AUDIO_SHARE_PROBE2(send_done, id, ec.value());
+        if (ec) {
+            self->_tx_timestamper.failed(ticket);
+        }
+        self->on_peer_sent(id, ec, bytes_transferred);
+    }));
+}
+
+void network_manager::on_peer_sent(int id, const asio::error_code& ec, size_t bytes)
+{
+    auto slot = _playing_peer_list.find(id);
+    if (slot == playing_peer_list_t::npos) {
+        return;
+    }
+
+    --_playing_peer_list.in_flight(slot);
+    auto& info = _playing_peer_list.info(slot);
+    if (ec) {
+        metrics::add(metrics::counter_send_errors);
+        flight_recorder::record(flight_recorder::event_send_error, id, (uint64_t)ec.value());
+        ++info.send_failures;
+        if (++info.send_errors == 1) {
+            rt_log::trace("{} id:{} {}", __func__, id, ec.message());
+        }
+        if (info.send_errors >= _max_send_errors) {
+            rt_log::info("{} evict id:{} after {} failed sends, {}", __func__, id, info.send_errors, ec.message());
+            evict_peer(slot);
+            return;
+        }
+    } else {
+        metrics::add(metrics::counter_bytes_sent, bytes);
+        metrics::add(metrics::counter_datagrams_sent);
+        flight_recorder::record(flight_recorder::event_send, id, bytes);
+        info.bytes_sent += bytes;
+        ++info.datagrams_sent;
+        info.send_errors = 0;
+    }
+}
+
+std::chrono::microseconds network_manager::playable_backlog(playing_peer_list_t::slot_t slot)
+{
+    // the client jitter buffer minus the time on the way and its variation, 0 means unknown
+    const auto& clock = _playing_peer_list.info(slot).clock;
+    const auto jitter_buffer_ms = _playing_peer_list.connection(slot)->jitter_buffer_ms;
+    if (!jitter_buffer_ms || !clock.measured()) {
+        return {};
+    }
+    const int64_t budget_us = (int64_t)jitter_buffer_ms * 1000 - clock.one_way_delay_us() - 2 * clock.rttvar_us();
+    return std::chrono::microseconds(std::max<int64_t>(budget_us, 1));
+}
+
+bool network_manager::admit(const std::shared_ptr<session_t>& session)
+{
+    if (has_capacity(session->profile)) {
+        return true;
+    }
+
+    // a cheaper output for the newcomer, it must follow the format change
+    if (session->hello && session->format_push && (!_max_players || _playing_peer_list.size() < _max_players)) {
+        auto cheaper = _profile_list[session->profile].profile.degraded();
+        if (!(cheaper == _profile_list[session->profile].profile)) {
+            auto profile = acquire_profile(cheaper);
+            if (has_capacity(profile)) {
+                rt_log::info("{} tcp://{} degraded to profile:{}", __func__, session->remote_endpoint, profile);
+                release_profile(session->profile);
+                session->profile = profile;
+                session->format_version = _capture_format.version();
+                std::string frame;
+                protocol::append_frame(frame, cmd_t::cmd_format_changed, _profile_list[profile].format_binary);
+                send(session, frame);
+                return true;
+            }
+            release_profile(profile);
+        }
+    }
+
+    // make room by preempting the players of a lower class, the last joined first
+    while (!has_capacity(session->profile)) {
+        auto victim = playing_peer_list_t::npos;
+        for (auto slot : _playing_peer_list.dense_slots()) {
+            auto priority = _playing_peer_list.connection(slot)->priority;
+            if (priority >= session->priority) {
+                continue;
+            }
+            if (victim == playing_peer_list_t::npos
+                || priority < _playing_peer_list.connection(victim)->priority
+                || (priority == _playing_peer_list.connection(victim)->priority && _playing_peer_list.id(slot) > _playing_peer_list.id(victim))) {
+                victim = slot;
+            }
+        }
+        if (victim == playing_peer_list_t::npos) {
+            rt_log::info("{} no capacity, refuse tcp://{} priority:{}", __func__, session->remote_endpoint, admission::to_string(session->priority));
+            return false;
+        }
+        rt_log::info("{} preempt id:{} for tcp://{}", __func__, _playing_peer_list.id(victim), session->remote_endpoint);
+        evict_peer(victim);
+    }
+    return true;
+}
+
+bool network_manager::has_capacity(uint8_t profile)
+{
+    if (_max_players && _playing_peer_list.size() >= _max_players) {
+        return false;
+    }
+    if (!_max_bandwidth) {
+        return true;
+    }
+
+    // the multicast stream costs the same for any number of players
+    const auto& entry = _profile_list[profile];
+    const uint64_t cost = entry.profile.multicast && entry.playing > 0 ? 0 : admission::stream_bitrate(_capture_format, entry.profile);
+    return used_bandwidth() + cost <= _max_bandwidth;
+}
+
+uint64_t network_manager::used_bandwidth()
+{
+    uint64_t bandwidth = 0;
+    for (auto& entry : _profile_list) {
+        if (entry.playing <= 0) {
+            continue;
+        }
+        auto bitrate = admission::stream_bitrate(_capture_format, entry.profile);
+        bandwidth += entry.profile.multicast ? bitrate : bitrate * entry.playing;
+    }
+    return bandwidth;
+}
+
+void network_manager::evict_peer(playing_peer_list_t::slot_t slot)
+{
+    // no grace period for a peer that can't be reached
+    auto& info = _playing_peer_list.info(slot);
+    _token_index.erase(info.token);
+    info.token = 0;
+
+    auto session = _playing_peer_list.connection(slot);
+    if (session->socket.is_open()) {
+        close_session(session);
+    } else {
+        drop_peer(session);
+    }
+}
+
+void network_manager::set_capture_active(bool active)
+{
+    _capture_active = active;
+    if (active) {
+        // the frames left before the pause are not contiguous with the new ones
+        _reframer.clear();
+        _drift_estimator.reset(_capture_format.sample_rate());
+    }
+    _resume_time = active ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
+    _last_fanout = {};
+    _audio_manager->set_active(active);
+}
+
+void network_manager::clear_history(profile_entry_t& entry)
+{
+    entry.history_base += entry.history.size();
+    entry.history.clear();
+    entry.history_frames = 0;
+}
+
+asio::awaitable<void> network_manager::prebuffer_burst(int id)
+{
+    auto slot = _playing_peer_list.find(id);
+    if (slot == playing_peer_list_t::npos) {
+        // left before the coroutine started
+        co_return;
+    }
+    const auto profile = _playing_peer_list.profile(slot);
+    const auto sample_rate = _capture_format.sample_rate() / (_profile_list[profile].profile.half_rate ? 2 : 1);
+    if (sample_rate <= 0) {
+        _playing_peer_list.clear_flags(slot, playing_peer_list_t::flag_catching_up);
+        co_return;
+    }
+
+    // start at most the client jitter buffer back from the head, less the way to the client once measured:
+    // older audio would arrive too late to be played
+    uint64_t cursor = 0;
+    {
+        const auto& entry = _profile_list[profile];
+        cursor = entry.history_base + entry.history.size();
+        uint64_t frames = 0;
+        uint64_t max_frames = entry.history_frames;
+        if (const auto backlog = playable_backlog(slot); backlog.count()) {
+            max_frames = std::min<uint64_t>(max_frames, (uint64_t)sample_rate * backlog.count() / 1000000);
+        } else if (auto jitter_buffer_ms = _playing_peer_list.connection(slot)->jitter_buffer_ms) {
+            max_frames = std::min<uint64_t>(max_frames, (uint64_t)sample_rate * jitter_buffer_ms / 1000);
+        }
+        while (cursor > entry.history_base && frames + entry.history[cursor - 1 - entry.history_base].frames <= max_frames) {
+            --cursor;
+            frames += entry.history[cursor - entry.history_base].frames;
+        }
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const auto start = cursor;
+    steady_timer timer(co_await asio::this_coro::executor);
+    while (true) {
+        // the peer may leave or the history may be cleared while waiting
+        slot = _playing_peer_list.find(id);
+        if (slot == playing_peer_list_t::npos) {
+            co_return;
+        }
+        // _profile_list may have grown, don't keep references over the wait
+        const auto& entry = _profile_list[profile];
+        cursor = std::max(cursor, entry.history_base);
+        if (cursor >= entry.history_base + entry.history.size()) {
+            // caught up with the live stream
+            _playing_peer_list.clear_flags(slot, playing_peer_list_t::flag_catching_up);
+            break;
+        }
+
+        const auto& history_entry = entry.history[cursor - entry.history_base];
+        send_to_peer(slot, history_entry.datagram);
+        ++cursor;
+
+        timer.expires_after(std::chrono::microseconds((uint64_t)history_entry.frames * 1000000 / (sample_rate * _prebuffer_speed)));
+        co_await timer.async_wait();
+    }
+
+    rt_log::info("{} id:{} datagrams:{} in {}ms", __func__, id, cursor - start,
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count());
+}
+
+void network_manager::notify_format_changed()
+{
+    if (!_ioc) {
+        return;
+    }
+    asio::post(*_ioc, asio::bind_allocator(handler_allocator<void>(), [self = shared_from_this()] {
+        self->push_format();
+    }));
+}
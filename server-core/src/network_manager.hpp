@@ -1,93 +1,307 @@
-/*
-   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
-
-   Licensed under the Apache License, Version 2.0 (the "License");
-   you may not use this file except in compliance with the License.
-   You may obtain a copy of the License at
-
-       http://www.apache.org/licenses/LICENSE-2.0
-
-   Unless required by applicable law or agreed to in writing, software
-   distributed under the License is distributed on an "AS IS" BASIS,
-   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-   See the License for the specific language governing permissions and
-   limitations under the License.
-*/
-
-#ifndef NETWORK_MANAGER_HPP
-#define NETWORK_MANAGER_HPP
-
-#include <memory>
-#include <vector>
-#include <string>
-#include <map>
-
-#include "pre_asio.hpp"
-#include <asio.hpp>
-#include <asio/use_awaitable.hpp>
-
-#include "audio_manager.hpp"
-
-class network_manager : public std::enable_shared_from_this<network_manager>
-{
-    using default_token = asio::as_tuple_t<asio::use_awaitable_t<>>;
-    using tcp_acceptor = default_token::as_default_on_t<asio::ip::tcp::acceptor>;
-    using tcp_socket = default_token::as_default_on_t<asio::ip::tcp::socket>;
-    using udp_socket = default_token::as_default_on_t<asio::ip::udp::socket>;
-    using steady_timer = default_token::as_default_on_t<asio::steady_timer>;
-
-    struct peer_info_t {
-        int id = 0;
-        asio::ip::udp::endpoint udp_peer;
-        std::chrono::steady_clock::time_point last_tick;
-    };
-
-    using playing_peer_list_t = std::map<std::shared_ptr<tcp_socket>, std::shared_ptr<peer_info_t>>;
-
-    enum class cmd_t : uint32_t {
-        cmd_none = 0,
-        cmd_get_format = 1,
-        cmd_start_play = 2,
-        cmd_heartbeat = 3,
-    };
-
-public:
-
-    explicit network_manager(std::shared_ptr<audio_manager>& audio_manager);
-
-    static std::vector<std::string> get_address_list();
-    static std::string get_default_address();
-private:
-    static std::string select_default_address(const std::vector<std::string>& address_list);
-
-public:
-    void start_server(const std::string& host, uint16_t port, const audio_manager::capture_config& capture_config);
-    void stop_server();
-    void wait_server();
-    bool is_running() const;
-
-private:
-    asio::awaitable<void> accept_tcp_loop(tcp_acceptor acceptor);
-    asio::awaitable<void> read_loop(std::shared_ptr<tcp_socket> peer);
-    asio::awaitable<void> heartbeat_loop(std::shared_ptr<tcp_socket> peer);
-    asio::awaitable<void> accept_udp_loop();
-    
-    playing_peer_list_t::iterator close_session(std::shared_ptr<tcp_socket>& peer);
-    int add_playing_peer(std::shared_ptr<tcp_socket>& peer);
-    playing_peer_list_t::iterator remove_playing_peer(std::shared_ptr<tcp_socket>& peer);
-    void fill_udp_peer(int id, asio::ip::udp::endpoint udp_peer);
-
-public:
-    void broadcast_audio_data(const char* data, size_t count, int block_align);
-    
-    std::shared_ptr<asio::io_context> _ioc;
-
-private:
-    std::shared_ptr<audio_manager> _audio_manager;
-    std::thread _net_thread;
-    std::unique_ptr<udp_socket> _udp_server;
-    playing_peer_list_t _playing_peer_list;
-    constexpr static auto _heartbeat_timeout = std::chrono::seconds(5);
-};
-
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef NETWORK_MANAGER_HPP
+#define NETWORK_MANAGER_HPP
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+#include <string>
+#include <unordered_set>
+
+#include "pre_asio.hpp"
+#include <asio.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include "admission.hpp"
+#include "audio_manager.hpp"
+#include "clock_estimator.hpp"
+#include "drift_estimator.hpp"
+#include "event_loop.hpp"
+#include "flight_recorder.hpp"
+#include "frame_reader.hpp"
+#include "handler_allocator.hpp"
+#include "histogram.hpp"
+#include "metrics.hpp"
+#include "output_profile.hpp"
+#include "peer_registry.hpp"
+#include "probes.hpp"
+#include "protocol.hpp"
+#include "realtime.hpp"
+#include "reframer.hpp"
+#include "resampler.hpp"
+#include "rt_log.hpp"
+#include "timer_wheel.hpp"
+#include "tx_timestamper.hpp"
+
+class network_manager : public std::enable_shared_from_this<network_manager>
+{
+    using default_token = asio::as_tuple_t<asio::use_awaitable_t<>>;
+    using tcp_acceptor = default_token::as_default_on_t<asio::ip::tcp::acceptor>;
+    using tcp_socket = default_token::as_default_on_t<asio::ip::tcp::socket>;
+    using udp_socket = default_token::as_default_on_t<asio::ip::udp::socket>;
+    using steady_timer = default_token::as_default_on_t<asio::steady_timer>;
+    using signal_set = default_token::as_default_on_t<asio::signal_set>;
+
+    using cmd_t = protocol::cmd_t;
+
+    // the buffers and handlers of the audio path are recycled, so a steady stream doesn't touch the heap
+    using datagram_t = std::vector<uint8_t, handler_allocator<uint8_t>>;
+    using datagram_ptr = std::shared_ptr<datagram_t>;
+
+    // one per tcp connection
+    struct session_t {
+        explicit session_t(const tcp_acceptor::executor_type& executor)
+            : socket(executor)
+        {
+        }
+
+        tcp_socket socket;
+        asio::ip::tcp::endpoint remote_endpoint;
+        frame_reader reader;
+        std::string outbox;     // queued by send()
+        std::string sending;    // owned by the pending async_write
+        bool format_push = false;
+        uint32_t format_version = 0; // last format version sent
+        bool hello = false;     // negotiated with cmd_hello
+        uint8_t profile = 0;    // index in _profile_list
+        uint32_t jitter_buffer_ms = 0;
+        bool adaptive_bitrate = false; // steps between profiles on its loss and delay reports
+        admission::priority_t priority = admission::priority_t::priority_normal;
+    };
+
+    struct history_entry_t {
+        datagram_ptr datagram;
+        uint32_t frames;
+    };
+
+    struct profile_entry_t {
+        output_profile_t profile;
+        int sessions = 0;   // sessions which negotiated it
+        int playing = 0;    // playing peers, the stream is sent only when not 0
+        uint32_t sequence = 0;
+        bool discontinuity = true;
+        std::string format_binary;      // serialized format of this profile
+        std::vector<uint8_t> converted; // scratch for the sample conversion
+        std::deque<history_entry_t> history; // the last datagrams, at most _prebuffer_ms long
+        uint64_t history_base = 0;  // absolute index of history.front()
+        uint64_t history_frames = 0;
+
+        // float path only
+        resampler rate_converter;
+        decimator half_rate_filter;
+        std::vector<float> downmixed;
+        std::vector<float> decimated;
+        std::vector<float> resample_in;
+        std::vector<float> resample_out;
+        double ratio = 1;           // output frames per capture frame
+        double rate_integral = 0;   // of the buffer error, in ms s
+        std::chrono::steady_clock::time_point last_rate_update;
+        uint64_t frame_position = 0; // of the stream out of the float path
+    };
+
+    struct peer_info_t {
+        std::chrono::steady_clock::time_point last_tick;
+        uint64_t token = 0;     // resumption token, 0 for the legacy clients
+        bool parked = false;    // tcp connection lost, waiting for a resume
+        std::chrono::steady_clock::time_point last_ping;
+        uint32_t last_sequence = 0; // reported by the last ping
+        clock_estimator clock;      // fed by the pings
+        uint32_t dropped = 0;
+        uint32_t send_errors = 0;   // consecutive
+        uint64_t bytes_sent = 0;
+        uint64_t datagrams_sent = 0;
+        uint64_t send_failures = 0;
+        std::shared_ptr<histogram> wire_delay; // send call to the wire, only with the tx timestamps
+        std::chrono::steady_clock::time_point last_report;
+        uint32_t buffered_us = 0;   // smoothed udp_report_t.buffered_us
+        uint32_t target_us = 0;
+        bool has_sync_error = false;
+        int32_t sync_error_us = 0;  // reported, played minus presentation time
+
+        // adaptive bitrate
+        std::vector<output_profile_t> ladder; // rung 0 is the profile of the first loss report
+        size_t ladder_level = 0;
+        uint32_t congested_reports = 0; // consecutive
+        uint32_t clear_reports = 0;     // consecutive
+        std::chrono::steady_clock::time_point last_switch;
+        double loss = 0;                // of the last report
+        int32_t delay_trend_us = 0;
+    };
+
+    using playing_peer_list_t = peer_registry<session_t, peer_info_t>;
+
+public:
+
+    explicit network_manager(std::shared_ptr<audio_manager>& audio_manager);
+
+    static std::vector<std::string> get_address_list();
+    static std::string get_default_address();
+private:
+    static std::string select_default_address(const std::vector<std::string>& address_list);
+
+public:
+    struct server_config {
+        std::string multicast_address;  // empty disables multicast
+        uint16_t multicast_port = 0;    // 0 means the server port
+        uint32_t packet_duration_us = 0; // 0 sends every captured quantum as one packet
+        uint32_t prebuffer_ms = 100;    // burst to a new udp peer, 0 disables it
+        uint16_t max_in_flight = 32;    // udp sends in flight per peer, past that the audio is dropped
+        uint32_t max_sessions = 0;      // tcp sessions, high priority ones excepted, 0 means no limit
+        uint32_t max_players = 0;       // 0 means no limit
+        uint64_t max_bandwidth = 0;     // bits per second of all the udp streams, 0 means no limit
+        std::vector<std::string> priority_rules; // see admission::parse_rule()
+        realtime::thread_config net_thread;
+        bool lock_memory = false;       // mlockall before the threads start
+        uint32_t busy_poll_us = 0;      // spin budget of the network loop, 0 sleeps in the kernel
+        std::string flight_recorder_dir; // dump the last pipeline events there on an anomaly, empty disables it
+        std::string metrics_address = "127.0.0.1";
+        uint16_t metrics_port = 0;      // serve http /metrics, 0 disables it
+        tx_timestamper::mode_t tx_timestamps = tx_timestamper::mode_off;
+        uint32_t playout_delay_ms = 0;  // presentation time minus capture time, 0 follows the farthest client
+    };
+
+    void start_server(const std::string& host, uint16_t port, const audio_manager::capture_config& capture_config, const server_config& server_config);
+    void stop_server();
+    void wait_server();
+    bool is_running() const;
+
+private:
+    asio::awaitable<void> accept_tcp_loop(tcp_acceptor acceptor);
+    asio::awaitable<void> read_loop(std::shared_ptr<session_t> session);
+    asio::awaitable<void> accept_metrics_loop(tcp_acceptor acceptor);
+    asio::awaitable<void> serve_metrics(tcp_socket socket);
+    std::string render_metrics();
+    bool handle_frame(const std::shared_ptr<session_t>& session, const frame_reader::frame_t& frame);
+    bool handle_hello(const std::shared_ptr<session_t>& session, std::string_view payload, std::string& reply);
+    void resume_session(const std::shared_ptr<session_t>& session, std::string_view payload, std::string& reply);
+    void send(const std::shared_ptr<session_t>& session, std::string_view data);
+    void flush(const std::shared_ptr<session_t>& session);
+    asio::awaitable<void> accept_udp_loop();
+    asio::awaitable<void> timer_loop();
+    asio::awaitable<void> tx_timestamp_loop();
+#ifdef SIGUSR1
+    asio::awaitable<void> signal_loop();
+#endif // SIGUSR1
+    void schedule_heartbeat(int id);
+    void on_heartbeat_timer(int id);
+    
+    void push_format();
+    void update_format_binary(uint8_t profile);
+    uint8_t acquire_profile(const output_profile_t& profile);
+    void release_profile(uint8_t profile);
+    void detect_send_gap(std::chrono::steady_clock::time_point now, size_t frames);
+    void send_audio_data(std::span<const uint8_t> data);
+    void send_datagram(uint8_t profile, const datagram_ptr& datagram);
+    void send_to_peer(playing_peer_list_t::slot_t slot, const datagram_ptr& datagram);
+    void start_send(int id, const asio::ip::udp::endpoint& udp_peer, const datagram_ptr& datagram);
+    void on_peer_sent(int id, const asio::error_code& ec, size_t bytes);
+    std::chrono::microseconds playable_backlog(playing_peer_list_t::slot_t slot);
+    void evict_peer(playing_peer_list_t::slot_t slot);
+    bool admit(const std::shared_ptr<session_t>& session);
+    bool has_capacity(uint8_t profile);
+    uint64_t used_bandwidth();
+    void set_capture_active(bool active);
+    void clear_history(profile_entry_t& entry);
+    asio::awaitable<void> prebuffer_burst(int id);
+    void close_session(const std::shared_ptr<session_t>& session);
+    void drop_peer(const std::shared_ptr<session_t>& session);
+    int add_playing_peer(const std::shared_ptr<session_t>& session);
+    void remove_playing_peer(const std::shared_ptr<session_t>& session);
+    void fill_udp_peer(int id, asio::ip::udp::endpoint udp_peer);
+    void resume_udp_peer(uint64_t token, asio::ip::udp::endpoint udp_peer);
+    void handle_ping(const protocol::udp_ping_t& ping, asio::ip::udp::endpoint udp_peer);
+    void handle_report(const protocol::udp_report_t& report, size_t size, asio::ip::udp::endpoint udp_peer);
+    void update_rate(uint8_t profile);
+    void adapt_bitrate(playing_peer_list_t::slot_t slot, const protocol::udp_report_t& report);
+    void switch_profile(playing_peer_list_t::slot_t slot, const output_profile_t& profile);
+    void reset_rate(profile_entry_t& entry);
+    void send_clock_report();
+    void update_playout_delay(std::chrono::steady_clock::time_point now);
+    uint64_t presentation_time_us(double capture_position) const;
+    void attach_udp_peer(playing_peer_list_t::slot_t slot, const asio::ip::udp::endpoint& udp_peer);
+
+public:
+    // `clock` is the capture clock at the first frame of data
+    void broadcast_audio_data(const char* data, size_t count, int block_align, const clock_reading_t& clock = {});
+    void notify_format_changed();
+    
+    std::shared_ptr<asio::io_context> _ioc;
+
+private:
+    std::shared_ptr<audio_manager> _audio_manager;
+    std::thread _net_thread;
+    std::unique_ptr<udp_socket> _udp_server;
+    std::unordered_set<std::shared_ptr<session_t>> _session_list;
+    playing_peer_list_t _playing_peer_list;
+    std::unordered_map<uint64_t, int> _token_index;
+    // the system CSPRNG, a seeded engine would make the next tokens predictable from one of them
+    std::random_device _token_source;
+    std::vector<profile_entry_t> _profile_list; // index 0 is the native profile, never released
+    output_profile_t::AudioFormat _capture_format; // copy of the audio_manager format owned by the net thread
+    uint64_t _frame_position = 0;
+    uint32_t _packet_duration_us = 0;
+    uint32_t _prebuffer_ms = 0;
+    uint16_t _max_in_flight = 0;
+    uint16_t _multicast_in_flight = 0;
+    uint32_t _max_sessions = 0;
+    uint32_t _max_players = 0;
+    uint64_t _max_bandwidth = 0;
+    std::vector<admission::rule_t> _priority_rules;
+    reframer _reframer;
+    tx_timestamper _tx_timestamper;
+    std::vector<tx_timestamper::sample_t> _tx_samples; // scratch of tx_timestamp_loop()
+    std::atomic_bool _capture_active = false;   // read by the capture thread
+    std::chrono::steady_clock::time_point _resume_time; // set until the first quantum after a resume
+    std::chrono::steady_clock::time_point _last_fanout; // reset when the stream restarts
+    std::chrono::nanoseconds _last_quantum {};
+    drift_estimator _drift_estimator;
+    std::chrono::steady_clock::time_point _last_clock_report;
+    std::chrono::steady_clock::time_point _anchor_time; // capture time of the capture frame _anchor_position
+    uint64_t _anchor_position = 0;
+    uint32_t _playout_delay_config_us = 0;
+    uint32_t _playout_delay_us = 0;
+    asio::ip::udp::endpoint _multicast_endpoint;
+    bool _multicast_enabled = false;
+    std::unique_ptr<steady_timer> _wheel_timer;
+    timer_wheel<int> _timer_wheel;
+    constexpr static auto _tick_interval = std::chrono::milliseconds(100);
+    constexpr static auto _heartbeat_interval = std::chrono::seconds(3);
+    constexpr static auto _heartbeat_timeout = std::chrono::seconds(5);
+    constexpr static auto _resume_grace = std::chrono::seconds(10);
+    constexpr static int _prebuffer_speed = 4; // burst pace, times the real time
+    constexpr static uint32_t _max_send_errors = 50; // consecutive failed sends before the peer is evicted
+    constexpr static size_t _max_metrics_request = 8192;
+    constexpr static uint64_t _stats_ticks = 100; // handler memory stats period, in wheel ticks
+    constexpr static auto _clock_report_interval = std::chrono::seconds(1);
+    constexpr static auto _report_timeout = std::chrono::seconds(5); // older buffer reports don't steer the rate
+    constexpr static double _rate_kp = 50;      // ppm per ms of buffer error
+    constexpr static double _rate_ki = 0.5;     // ppm per ms s
+    constexpr static double _max_rate_ppm = 1000;
+    constexpr static auto _min_playout_delay = std::chrono::milliseconds(50);
+    constexpr static auto _playout_margin = std::chrono::milliseconds(20); // on top of the path of the farthest client
+    constexpr static double _abr_loss_high = 0.02;    // a report above steps down
+    constexpr static double _abr_loss_low = 0.005;    // reports below may step up
+    constexpr static int32_t _abr_trend_high_us = 5000;
+    constexpr static int32_t _abr_trend_low_us = 1000;
+    constexpr static uint32_t _abr_down_reports = 2;  // congested in a row
+    constexpr static uint32_t _abr_up_reports = 10;   // clear in a row
+    constexpr static auto _abr_up_hold = std::chrono::seconds(10); // since the last switch
+};
+
 #endif // !NETWORK_MANAGER_HPP
\ No newline at end of file
@@ -0,0 +1,162 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "output_profile.hpp"
+#include "sample_format.hpp"
+
+#include <algorithm>
+
+using namespace io::github::mkckr0::audio_share_app::pb;
+
+namespace {
+
+int sample_bits(AudioFormat_Encoding encoding)
+{
+    // float has a 24 bits mantissa
+    if (encoding == AudioFormat_Encoding_ENCODING_PCM_FLOAT) {
+        return 24;
+    }
+    return sample_format::bytes_per_sample(encoding) * 8;
+}
+
+} // namespace
+
+output_profile_t::encoding_t output_profile_t::select_encoding(encoding_t capture_encoding) const
+{
+    if (encoding_mask == 0) {
+        return capture_encoding;
+    }
+
+    const int floor_bits = std::min(16, sample_bits(capture_encoding));
+    auto best = AudioFormat_Encoding_ENCODING_INVALID;
+    for (int e = AudioFormat_Encoding_ENCODING_PCM_FLOAT; e <= AudioFormat_Encoding_ENCODING_PCM_32BIT; ++e) {
+        auto encoding = (encoding_t)e;
+        if (!(encoding_mask & (1u << e)) || sample_bits(encoding) < floor_bits) {
+            continue;
+        }
+        auto size = sample_format::bytes_per_sample(encoding);
+        auto best_size = sample_format::bytes_per_sample(best);
+        if (best_size == 0 || size < best_size || (size == best_size && encoding == capture_encoding)) {
+            best = encoding;
+        }
+    }
+    if (best != AudioFormat_Encoding_ENCODING_INVALID) {
+        return best;
+    }
+
+    // nothing keeps the floor, take the widest one
+    for (int e = AudioFormat_Encoding_ENCODING_PCM_FLOAT; e <= AudioFormat_Encoding_ENCODING_PCM_32BIT; ++e) {
+        auto encoding = (encoding_t)e;
+        if (encoding_mask & (1u << e) && (best == AudioFormat_Encoding_ENCODING_INVALID || sample_bits(encoding) > sample_bits(best))) {
+            best = encoding;
+        }
+    }
+    return best;
+}
+
+AudioFormat output_profile_t::make_format(const AudioFormat& capture_format) const
+{
+    AudioFormat format = capture_format;
+    format.set_encoding(select_encoding(capture_format.encoding()));
+    if (half_rate) {
+        format.set_sample_rate(capture_format.sample_rate() / 2);
+        format.set_frames_per_packet(capture_format.frames_per_packet() / 2);
+    }
+    if (mono) {
+        format.set_channels(1);
+    }
+    return format;
+}
+
+output_profile_t output_profile_t::degraded() const
+{
+    output_profile_t profile = *this;
+    int best_size = 0;
+    for (int e = AudioFormat_Encoding_ENCODING_PCM_FLOAT; e <= AudioFormat_Encoding_ENCODING_PCM_32BIT; ++e) {
+        if (!(encoding_mask & (1u << e))) {
+            continue;
+        }
+        int size = sample_format::bytes_per_sample((encoding_t)e);
+        if (best_size == 0 || size < best_size) {
+            best_size = size;
+            profile.encoding_mask = 1u << e;
+        }
+    }
+    return profile;
+}
+
+std::vector<output_profile_t> output_profile_t::ladder(const AudioFormat& capture_format) const
+{
+    std::vector<output_profile_t> steps { *this };
+    if (multicast) {
+        return steps;
+    }
+
+    auto step = *this;
+    constexpr auto s16 = AudioFormat_Encoding_ENCODING_PCM_16BIT;
+    if (encoding_mask & (1u << s16) && sample_format::bytes_per_sample(select_encoding(capture_format.encoding())) > 2) {
+        step.encoding_mask = 1u << s16;
+        steps.push_back(step);
+    }
+    // below 32 kHz, half rate cuts into the voice band
+    if (!step.half_rate && capture_format.sample_rate() >= 32000) {
+        step.half_rate = true;
+        steps.push_back(step);
+    }
+    if (!step.mono && capture_format.channels() > 1) {
+        step.mono = true;
+        steps.push_back(step);
+    }
+    return steps;
+}
+
+output_profile_t output_profile_t::native()
+{
+    return {};
+}
+
+output_profile_t output_profile_t::multicast_stream()
+{
+    output_profile_t profile;
+    profile.packet_header = true;
+    profile.multicast = true;
+    return profile;
+}
+
+output_profile_t output_profile_t::select(const ClientHello& hello, encoding_t capture_encoding, bool multicast_enabled)
+{
+    output_profile_t profile;
+    for (auto e : hello.encodings()) {
+        if (sample_format::bytes_per_sample((encoding_t)e) != 0) {
+            profile.encoding_mask |= 1u << e;
+        }
+    }
+    profile.packet_header = hello.packet_header();
+    if (hello.max_payload_size() != 0) {
+        profile.max_payload_size = std::clamp(hello.max_payload_size(), min_payload_size, default_payload_size);
+    }
+
+    // the group carries the capture encoding with headers and the default payload size,
+    // a client has to take all of that to join it
+    if (multicast_enabled && hello.multicast() && profile.packet_header
+        && profile.max_payload_size == default_payload_size
+        && (profile.encoding_mask == 0 || profile.encoding_mask & (1u << capture_encoding))) {
+        return multicast_stream();
+    }
+    profile.adaptive_rate = hello.adaptive_rate() && profile.packet_header;
+    profile.presentation_time = hello.presentation_time() && profile.packet_header;
+    return profile;
+}
@@ -0,0 +1,72 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef OUTPUT_PROFILE_HPP
+#define OUTPUT_PROFILE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "client.pb.h"
+
+// What a group of clients receives on the udp channel.
+// Clients negotiating the same profile share one converted and segmented stream.
+struct output_profile_t {
+    using AudioFormat = io::github::mkckr0::audio_share_app::pb::AudioFormat;
+    using ClientHello = io::github::mkckr0::audio_share_app::pb::ClientHello;
+    using encoding_t = AudioFormat::Encoding;
+
+    // the ipv4 minimum reassembly size, minus ip and udp headers
+    static constexpr uint32_t default_payload_size = 1492 - 20 - 8;
+    static constexpr uint32_t min_payload_size = 256;
+
+    // bit (1 << encoding) for every encoding the clients accept, 0 means the capture encoding only
+    uint32_t encoding_mask = 0;
+    bool packet_header = false;
+    uint32_t max_payload_size = default_payload_size;
+    bool multicast = false;
+    bool adaptive_rate = false; // resampled to follow the buffer reports of its clients
+    bool presentation_time = false; // every datagram carries the time to play it
+    bool half_rate = false; // half the capture sample rate
+    bool mono = false; // the capture channels mixed down to one
+
+    bool operator==(const output_profile_t&) const = default;
+
+    // the stream goes through float samples before the output encoding
+    bool float_path() const { return adaptive_rate || half_rate || mono; }
+
+    // the cheapest encoding which keeps min(16, capture bits) of resolution
+    encoding_t select_encoding(encoding_t capture_encoding) const;
+
+    // format sent to the clients of this profile
+    AudioFormat make_format(const AudioFormat& capture_format) const;
+
+    // the same profile restricted to the cheapest encoding the clients accept, below the quality floor if needed
+    output_profile_t degraded() const;
+
+    // the adaptive bitrate steps, from this profile down to 16 bits, then half rate, then mono
+    std::vector<output_profile_t> ladder(const AudioFormat& capture_format) const;
+
+    // what a client without ClientHello gets
+    static output_profile_t native();
+
+    // the one stream sent to the multicast group
+    static output_profile_t multicast_stream();
+
+    static output_profile_t select(const ClientHello& hello, encoding_t capture_encoding, bool multicast_enabled);
+};
+
+#endif // !OUTPUT_PROFILE_HPP
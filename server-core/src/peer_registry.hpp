@@ -0,0 +1,222 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef PEER_REGISTRY_HPP
+#define PEER_REGISTRY_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "pre_asio.hpp"
+#include <asio.hpp>
+
+// Playing peer table.
+// Peers live in stable slots, so a slot index stays valid until the peer is removed.
+// The data touched by the broadcast fan-out (udp endpoint, flags, output profile, sends in flight and id) is kept packed
+// in dense arrays, removal swaps the last dense element into the hole.
+template <typename Connection, typename Info>
+class peer_registry {
+public:
+    using connection_ptr = std::shared_ptr<Connection>;
+    using endpoint_t = asio::ip::udp::endpoint;
+    using slot_t = uint32_t;
+
+    static constexpr slot_t npos = std::numeric_limits<slot_t>::max();
+
+    enum flag_t : uint8_t {
+        flag_none = 0,
+        flag_udp_ready = 1 << 0,
+        flag_catching_up = 1 << 1, // fed from the prebuffer, skipped by the live fan-out
+    };
+
+    // return npos if the connection or the id is already registered
+    slot_t add(const connection_ptr& connection, int id)
+    {
+        if (_connection_index.contains(connection.get()) || _id_index.contains(id)) {
+            return npos;
+        }
+
+        slot_t slot;
+        if (_free_slots.empty()) {
+            slot = (slot_t)_slots.size();
+            _slots.emplace_back();
+        } else {
+            slot = _free_slots.back();
+            _free_slots.pop_back();
+        }
+
+        auto& entry = _slots[slot];
+        entry.dense = (uint32_t)_dense_slots.size();
+        entry.id = id;
+        entry.connection = connection;
+        entry.info = Info {};
+
+        _udp_peers.emplace_back();
+        _flags.push_back(flag_none);
+        _profiles.push_back(0);
+        _in_flight.push_back(0);
+        _ids.push_back(id);
+        _dense_slots.push_back(slot);
+
+        _id_index.emplace(id, slot);
+        _connection_index.emplace(connection.get(), slot);
+        return slot;
+    }
+
+    // move the peer to another connection, return false if that one is already registered
+    bool rebind(slot_t slot, const connection_ptr& connection)
+    {
+        if (_connection_index.contains(connection.get())) {
+            return false;
+        }
+
+        auto& entry = _slots[slot];
+        _connection_index.erase(entry.connection.get());
+        entry.connection = connection;
+        _connection_index.emplace(connection.get(), slot);
+        return true;
+    }
+
+    bool remove(slot_t slot)
+    {
+        if (!contains(slot)) {
+            return false;
+        }
+
+        auto& entry = _slots[slot];
+        const auto hole = entry.dense;
+        const auto last = (uint32_t)_dense_slots.size() - 1;
+        if (hole != last) {
+            _udp_peers[hole] = _udp_peers[last];
+            _flags[hole] = _flags[last];
+            _profiles[hole] = _profiles[last];
+            _in_flight[hole] = _in_flight[last];
+            _ids[hole] = _ids[last];
+            _dense_slots[hole] = _dense_slots[last];
+            _slots[_dense_slots[hole]].dense = hole;
+        }
+        _udp_peers.pop_back();
+        _flags.pop_back();
+        _profiles.pop_back();
+        _in_flight.pop_back();
+        _ids.pop_back();
+        _dense_slots.pop_back();
+
+        _id_index.erase(entry.id);
+        _connection_index.erase(entry.connection.get());
+
+        entry.dense = npos;
+        entry.id = 0;
+        entry.connection = nullptr;
+        entry.info = Info {};
+        _free_slots.push_back(slot);
+        return true;
+    }
+
+    void clear()
+    {
+        _slots.clear();
+        _free_slots.clear();
+        _udp_peers.clear();
+        _flags.clear();
+        _profiles.clear();
+        _in_flight.clear();
+        _ids.clear();
+        _dense_slots.clear();
+        _id_index.clear();
+        _connection_index.clear();
+    }
+
+    slot_t find(int id) const
+    {
+        auto it = _id_index.find(id);
+        return it == _id_index.end() ? npos : it->second;
+    }
+
+    slot_t find(const Connection* connection) const
+    {
+        auto it = _connection_index.find(connection);
+        return it == _connection_index.end() ? npos : it->second;
+    }
+
+    bool contains(slot_t slot) const
+    {
+        return slot < _slots.size() && _slots[slot].dense != npos;
+    }
+
+    bool empty() const { return _dense_slots.empty(); }
+    size_t size() const { return _dense_slots.size(); }
+
+    int id(slot_t slot) const { return _slots[slot].id; }
+    const connection_ptr& connection(slot_t slot) const { return _slots[slot].connection; }
+    Info& info(slot_t slot) { return _slots[slot].info; }
+    const Info& info(slot_t slot) const { return _slots[slot].info; }
+
+    const endpoint_t& udp_peer(slot_t slot) const { return _udp_peers[_slots[slot].dense]; }
+    void set_udp_peer(slot_t slot, const endpoint_t& endpoint)
+    {
+        auto dense = _slots[slot].dense;
+        _udp_peers[dense] = endpoint;
+        _flags[dense] |= flag_udp_ready;
+    }
+
+    uint8_t flags(slot_t slot) const { return _flags[_slots[slot].dense]; }
+    void set_flags(slot_t slot, uint8_t flags) { _flags[_slots[slot].dense] |= flags; }
+    void clear_flags(slot_t slot, uint8_t flags) { _flags[_slots[slot].dense] &= ~flags; }
+
+    // index into the owner's output profile table
+    uint8_t profile(slot_t slot) const { return _profiles[_slots[slot].dense]; }
+    void set_profile(slot_t slot, uint8_t profile) { _profiles[_slots[slot].dense] = profile; }
+
+    // udp sends not completed yet
+    uint16_t& in_flight(slot_t slot) { return _in_flight[_slots[slot].dense]; }
+
+    // dense view, index i of every span refers to the same peer
+    std::span<const endpoint_t> udp_peers() const { return _udp_peers; }
+    std::span<const uint8_t> dense_flags() const { return _flags; }
+    std::span<const uint8_t> dense_profiles() const { return _profiles; }
+    std::span<uint16_t> dense_in_flight() { return _in_flight; }
+    std::span<const int> dense_ids() const { return _ids; }
+    std::span<const slot_t> dense_slots() const { return _dense_slots; }
+
+private:
+    struct slot_entry_t {
+        uint32_t dense = npos;
+        int id = 0;
+        connection_ptr connection;
+        Info info;
+    };
+
+    std::vector<slot_entry_t> _slots;
+    std::vector<slot_t> _free_slots;
+
+    // hot, packed by dense index
+    std::vector<endpoint_t> _udp_peers;
+    std::vector<uint8_t> _flags;
+    std::vector<uint8_t> _profiles;
+    std::vector<uint16_t> _in_flight;
+    std::vector<int> _ids;
+    std::vector<slot_t> _dense_slots;
+
+    std::unordered_map<int, slot_t> _id_index;
+    std::unordered_map<const Connection*, slot_t> _connection_index;
+};
+
+#endif // !PEER_REGISTRY_HPP
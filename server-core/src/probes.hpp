@@ -0,0 +1,52 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef PROBES_HPP
+#define PROBES_HPP
+
+// USDT probes of the provider "audio_share", built with -DAUDIO_SHARE_USDT=ON when <sys/sdt.h> is found.
+// A disabled probe is a single nop, but its arguments are asm operands and always evaluated, keep them cheap.
+//
+//   capture_entry()                          capture callback begins
+//   capture_exit(bytes)                      capture callback ends, bytes captured
+//   segment(profile, bytes, datagrams)       one packet cut for an output profile
+//   send(id, bytes)                          udp send to a peer, id 0 is the multicast group
+//   send_done(id, error)                     completion of a udp send, error is 0 on success
+//   peer_add(id)
+//   peer_remove(id)
+//   heartbeat_timeout(id)
+//
+// e.g. bpftrace -e 'usdt:/usr/bin/as-cmd:audio_share:send_done /arg1/ { @errors[arg0] = count(); }'
+
+#if defined(AUDIO_SHARE_USDT) && __has_include(<sys/sdt.h>)
+
+#include <sys/sdt.h>
+
+#define AUDIO_SHARE_PROBE(name) DTRACE_PROBE(audio_share, name)
+#define AUDIO_SHARE_PROBE1(name, a) DTRACE_PROBE1(audio_share, name, a)
+#define AUDIO_SHARE_PROBE2(name, a, b) DTRACE_PROBE2(audio_share, name, a, b)
+#define AUDIO_SHARE_PROBE3(name, a, b, c) DTRACE_PROBE3(audio_share, name, a, b, c)
+
+#else
+
+#define AUDIO_SHARE_PROBE(name) ((void)0)
+#define AUDIO_SHARE_PROBE1(name, a) ((void)0)
+#define AUDIO_SHARE_PROBE2(name, a, b) ((void)0)
+#define AUDIO_SHARE_PROBE3(name, a, b, c) ((void)0)
+
+#endif
+
+#endif // !PROBES_HPP
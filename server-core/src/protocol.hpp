@@ -0,0 +1,165 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Control channel wire format, all integers are little endian.
+//
+// The commands of the first protocol version are bare 4 bytes values.
+// Every other command is a frame: cmd, uint32 payload size, then the payload.
+namespace protocol {
+
+enum class cmd_t : uint32_t {
+    cmd_none = 0,
+    cmd_get_format = 1,
+    cmd_start_play = 2,
+    cmd_heartbeat = 3,
+
+    // client -> server, empty: subscribe to format changes, the server replies with the current format
+    // server -> client, AudioFormat: the capture format has changed, sent only to subscribed sessions
+    cmd_format_changed = 4,
+
+    // client -> server, ClientHello: sent before cmd_get_format to negotiate the output
+    // server -> client, ServerHello
+    cmd_hello = 5,
+
+    // server -> client, uint64 token: sent after the cmd_start_play reply to the sessions negotiated with cmd_hello
+    cmd_session_token = 6,
+
+    // client -> server, uint64 token: take over a disconnected peer on a new connection
+    // server -> client, int id of the peer, empty if the token is unknown or expired
+    cmd_resume = 7,
+
+    // server -> client, empty: cmd_start_play refused by the admission control, the session stays open
+    cmd_refused = 8,
+};
+
+// Datagrams sent by the client to the udp server.
+// The 4 bytes id of the first protocol version is the only one that short,
+// every longer datagram starts with a udp_msg_t.
+// The server messages follow a packet_header_t with flag_control.
+enum class udp_msg_t : uint32_t {
+    udp_msg_none = 0,
+    udp_msg_resume = 1, // udp_resume_t
+    udp_msg_ping = 2,   // udp_ping_t, answered with udp_pong_t
+    udp_msg_report = 3, // udp_report_t
+    udp_msg_clock = 4,  // udp_clock_t, server -> client
+};
+
+constexpr uint32_t version = 2;
+constexpr uint32_t first_framed_cmd = 4;
+constexpr size_t max_payload_size = 64 * 1024;
+
+// put in front of the PCM data of every udp datagram when ServerHello.packet_header is set
+#pragma pack(push, 1)
+struct packet_header_t {
+    enum flag_t : uint32_t {
+        flag_none = 0,
+        flag_discontinuity = 1 << 0, // the previous datagrams of this stream are not contiguous with this one
+        flag_presentation_time = 1 << 1, // an uint64 presentation time in us, on the server clock, follows the header
+        flag_control = 1u << 31,     // no audio, a server message follows the header
+    };
+
+    uint32_t sequence; // per output stream, wraps around
+    uint32_t flags;
+    uint64_t frame_position; // first frame of the payload, counted from the capture start
+};
+#pragma pack(pop)
+
+static_assert(sizeof(packet_header_t) == 16);
+
+// receive on this endpoint, the peer of `token` is resumed even without tcp connection
+#pragma pack(push, 1)
+struct udp_resume_t {
+    udp_msg_t type;
+    uint64_t token;
+};
+
+// receiver report, also keeps the peer alive without tcp connection
+struct udp_ping_t {
+    udp_msg_t type;
+    uint64_t token;
+    uint32_t last_sequence;  // last packet_header_t.sequence received
+    uint64_t client_time_us; // client clock when the ping is sent, echoed in the pong
+    uint64_t echo_time_us;   // server_time_us of the last pong, 0 if none
+    uint64_t echo_delay_us;  // time between the reception of that pong and this ping
+};
+
+// sent after a packet_header_t with flag_control, only to the clients negotiating the header
+struct udp_pong_t {
+    udp_msg_t type;
+    uint64_t client_time_us;
+    uint64_t server_time_us;
+};
+
+// playout state of the client, steers the adaptive rate
+struct udp_report_t {
+    udp_msg_t type;
+    uint64_t token;
+    uint32_t buffered_us; // audio received and not played yet
+    uint32_t target_us;   // what the client aims at, 0 means ClientHello.jitter_buffer_ms
+    int32_t sync_error_us; // time the last frame was played minus its presentation time, 0 out of sync, absent from shorter reports
+    // since the last report, absent from shorter reports too
+    uint32_t packets_expected; // sequence span received
+    uint32_t packets_lost;     // of those, never received
+    int32_t delay_trend_us;    // change of the transit time, arrival minus send, the queues building up
+};
+
+constexpr size_t min_report_size = offsetof(udp_report_t, sync_error_us);
+
+// capture clock of the stream, sent every second to the clients negotiating the header
+struct udp_clock_t {
+    udp_msg_t type;
+    uint64_t frame_position; // frame of the stream captured at server_time_us
+    uint64_t server_time_us; // clock of udp_pong_t.server_time_us
+    int32_t drift_ppb;       // stream frames per server clock second over the sample rate, minus 1, in ppb
+    uint32_t playout_delay_us; // presentation time minus capture time
+};
+#pragma pack(pop)
+
+constexpr bool is_framed(uint32_t cmd)
+{
+    return cmd >= first_framed_cmd;
+}
+
+template <typename T>
+void append_value(std::string& buffer, const T& value)
+{
+    buffer.append((const char*)&value, sizeof(value));
+}
+
+inline void append_cmd(std::string& buffer, cmd_t cmd)
+{
+    append_value(buffer, cmd);
+}
+
+// `cmd_get_format` reply uses the frame layout too
+inline void append_frame(std::string& buffer, cmd_t cmd, std::string_view payload)
+{
+    append_value(buffer, cmd);
+    append_value(buffer, (uint32_t)payload.size());
+    buffer.append(payload);
+}
+
+} // namespace protocol
+
+#endif // !PROTOCOL_HPP
@@ -0,0 +1,194 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "realtime.hpp"
+#include "handler_allocator.hpp"
+#include "rt_log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WINDOWS
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <pipewire/pipewire.h>
+#endif // _WINDOWS
+
+#include <fmt/ranges.h>
+
+namespace realtime {
+
+namespace {
+
+    constexpr size_t prefault_stack_size = 256 * 1024;
+    constexpr size_t prefault_blocks = 32; // per size class
+
+    void prefault_stack()
+    {
+        volatile uint8_t stack[prefault_stack_size];
+        for (size_t i = 0; i < prefault_stack_size; i += 4096) {
+            stack[i] = 0;
+        }
+        // read back, so the array is used
+        (void)stack[prefault_stack_size - 1];
+    }
+
+} // namespace
+
+std::vector<int> parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cpus;
+    size_t begin = 0;
+    while (begin < list.size()) {
+        auto end = list.find(',', begin);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        auto item = list.substr(begin, end - begin);
+        begin = end + 1;
+
+        auto dash = item.find('-');
+        size_t first_end = 0, last_end = 0;
+        int first, last;
+        try {
+            first = std::stoi(item.substr(0, dash), &first_end);
+            last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1), &last_end);
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("invalid cpu list: " + list);
+        }
+        if (first < 0 || last < first || first_end != item.substr(0, dash).size()
+            || (dash != std::string::npos && last_end != item.size() - dash - 1)) {
+            throw std::invalid_argument("invalid cpu list: " + list);
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::ranges::sort(cpus);
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+#ifdef _WINDOWS
+
+void apply(const char* name, const thread_config& config)
+{
+    if (!config.cpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : config.cpus) {
+            if (cpu < (int)sizeof(mask) * 8) {
+                mask |= DWORD_PTR(1) << cpu;
+            }
+        }
+        if (!SetThreadAffinityMask(GetCurrentThread(), mask)) {
+            rt_log::warn("{} thread affinity {}: error {}", name, fmt::format("{}", fmt::join(config.cpus, ",")), GetLastError());
+        }
+    }
+    if (config.priority > 0) {
+        // windows has no priority range, every realtime setting maps to the highest class
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            rt_log::warn("{} thread priority: error {}", name, GetLastError());
+        }
+    }
+
+    rt_log::info("{} thread priority:{} cpus:{}", name, GetThreadPriority(GetCurrentThread()),
+        config.cpus.empty() ? std::string("all") : fmt::format("{}", fmt::join(config.cpus, ",")));
+}
+
+bool lock_memory()
+{
+    rt_log::warn("memory locking is not supported on this platform");
+    return false;
+}
+
+#else
+
+void apply(const char* name, const thread_config& config)
+{
+    if (!config.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : config.cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+            rt_log::warn("{} thread affinity {}: {}", name, fmt::format("{}", fmt::join(config.cpus, ",")), std::strerror(err));
+        }
+    }
+
+    const char* granted_by = "";
+    if (config.priority > 0) {
+        const int policy = config.round_robin ? SCHED_RR : SCHED_FIFO;
+        sched_param param {};
+        param.sched_priority = std::clamp(config.priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+        int err = pthread_setschedparam(pthread_self(), policy, &param);
+        granted_by = " (sched_setscheduler)";
+        if (err == EPERM) {
+            // no CAP_SYS_NICE nor RLIMIT_RTPRIO, ask RTKit through the PipeWire rt module
+            err = -pw_thread_utils_acquire_rt((struct spa_thread*)pthread_self(), param.sched_priority);
+            granted_by = " (rtkit)";
+        }
+        if (err) {
+            rt_log::warn("{} thread priority {}: {}", name, param.sched_priority, std::strerror(err));
+            granted_by = "";
+        }
+    }
+
+    int policy = SCHED_OTHER;
+    sched_param param {};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    const char* policy_name = policy == SCHED_FIFO ? "fifo" : policy == SCHED_RR ? "rr" : "other";
+
+    std::vector<int> cpus;
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+
+    rt_log::info("{} thread policy:{} priority:{}{} cpus:{}", name, policy_name, param.sched_priority, granted_by,
+        fmt::format("{}", fmt::join(cpus, ",")));
+}
+
+bool lock_memory()
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+        rt_log::warn("lock memory: {}", std::strerror(errno));
+        return false;
+    }
+    rt_log::info("memory locked");
+    return true;
+}
+
+#endif // _WINDOWS
+
+void prefault()
+{
+    prefault_stack();
+    handler_memory::prefault(prefault_blocks);
+}
+
+} // namespace realtime
@@ -0,0 +1,47 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+#include <string>
+#include <vector>
+
+// Opt-in scheduling settings of the audio threads.
+// Nothing is changed unless asked, every setting is reported whether it succeeds or not.
+namespace realtime {
+
+struct thread_config {
+    int priority = 0;         // realtime priority, 1 to 99, 0 keeps the default scheduling
+    bool round_robin = false; // SCHED_RR instead of SCHED_FIFO
+    std::vector<int> cpus;    // affinity, empty allows every cpu
+};
+
+// "0,2-3", throw std::invalid_argument
+std::vector<int> parse_cpu_list(const std::string& list);
+
+// apply to the calling thread, then report its effective scheduling
+void apply(const char* name, const thread_config& config);
+
+// lock the current and future pages of the process, so the audio path never waits for a page fault
+bool lock_memory();
+
+// fault in the stack and the handler memory cache of the calling thread
+void prefault();
+
+} // namespace realtime
+
+#endif // !REALTIME_HPP
@@ -0,0 +1,25 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "reframer.hpp"
+
+void reframer::reset(size_t frame_size, size_t frames_per_packet)
+{
+    _frame_size = frame_size;
+    _packet_size = frame_size * frames_per_packet;
+    _pending.clear();
+    _pending.reserve(_packet_size);
+}
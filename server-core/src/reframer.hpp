@@ -0,0 +1,72 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef REFRAMER_HPP
+#define REFRAMER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Cuts the captured quanta into packets of a fixed number of frames.
+// Whole packets are passed straight from the input, only the remainder is copied.
+class reframer {
+public:
+    // `frames_per_packet` 0 passes every quantum through unchanged
+    void reset(size_t frame_size, size_t frames_per_packet);
+
+    // drop the pending frames
+    void clear() { _pending.clear(); }
+
+    // call `fn(packet)` for every complete packet
+    template <typename Fn>
+    void push(std::span<const uint8_t> data, Fn&& fn)
+    {
+        if (_packet_size == 0) {
+            fn(data);
+            return;
+        }
+
+        // complete the pending packet first
+        if (!_pending.empty()) {
+            auto n = std::min(_packet_size - _pending.size(), data.size());
+            _pending.insert(_pending.end(), data.begin(), data.begin() + n);
+            data = data.subspan(n);
+            if (_pending.size() < _packet_size) {
+                return;
+            }
+            fn(std::span<const uint8_t>(_pending));
+            _pending.clear();
+        }
+
+        while (data.size() >= _packet_size) {
+            fn(data.first(_packet_size));
+            data = data.subspan(_packet_size);
+        }
+        _pending.assign(data.begin(), data.end());
+    }
+
+    size_t frames_per_packet() const { return _frame_size ? _packet_size / _frame_size : 0; }
+    size_t pending_frames() const { return _frame_size ? _pending.size() / _frame_size : 0; }
+
+private:
+    size_t _frame_size = 0;
+    size_t _packet_size = 0;
+    std::vector<uint8_t> _pending;
+};
+
+#endif // !REFRAMER_HPP
@@ -0,0 +1,120 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "resampler.hpp"
+
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+    // blackman windowed sinc, cut at 0.22 of the input rate, a bit below the new nyquist frequency
+    std::array<float, decimator::tap_count> make_taps()
+    {
+        constexpr double cutoff = 0.22;
+        constexpr double middle = (decimator::tap_count - 1) / 2.0;
+        std::array<double, decimator::tap_count> taps;
+        double sum = 0;
+        for (size_t i = 0; i < taps.size(); ++i) {
+            const double x = (double)i - middle;
+            const double sinc = x == 0 ? 2 * cutoff : std::sin(2 * std::numbers::pi * cutoff * x) / (std::numbers::pi * x);
+            const double window = 0.42 - 0.5 * std::cos(2 * std::numbers::pi * i / (taps.size() - 1)) + 0.08 * std::cos(4 * std::numbers::pi * i / (taps.size() - 1));
+            taps[i] = sinc * window;
+            sum += taps[i];
+        }
+        std::array<float, decimator::tap_count> normalized;
+        for (size_t i = 0; i < taps.size(); ++i) {
+            normalized[i] = (float)(taps[i] / sum);
+        }
+        return normalized;
+    }
+
+} // namespace
+
+void resampler::reset(size_t channels)
+{
+    _channels = channels;
+    _frames.assign(3 * channels, 0.0f);
+    _phase = 0;
+}
+
+void resampler::process(std::span<const float> in, double ratio, std::vector<float>& out)
+{
+    if (_channels == 0 || ratio <= 0) {
+        return;
+    }
+    _frames.insert(_frames.end(), in.begin(), in.end());
+
+    // interpolate between frames i and i + 1, with i - 1 and i + 2 around
+    const size_t frames = _frames.size() / _channels;
+    const double step = 1 / ratio;
+    out.reserve(out.size() + (size_t)((double)in.size() * ratio) + 2 * _channels);
+    while (_phase + 3 < (double)frames) {
+        const size_t i = (size_t)_phase + 1;
+        const float t = (float)(_phase + 1 - (double)i);
+        const float* p0 = &_frames[(i - 1) * _channels];
+        const float* p1 = p0 + _channels;
+        const float* p2 = p1 + _channels;
+        const float* p3 = p2 + _channels;
+        for (size_t c = 0; c < _channels; ++c) {
+            const float a = -0.5f * p0[c] + 1.5f * p1[c] - 1.5f * p2[c] + 0.5f * p3[c];
+            const float b = p0[c] - 2.5f * p1[c] + 2.0f * p2[c] - 0.5f * p3[c];
+            const float d = -0.5f * p0[c] + 0.5f * p2[c];
+            out.push_back(((a * t + b) * t + d) * t + p1[c]);
+        }
+        _phase += step;
+    }
+
+    // keep the last 3 frames, the phase follows them
+    const size_t consumed = frames - 3;
+    _frames.erase(_frames.begin(), _frames.begin() + consumed * _channels);
+    _phase -= (double)consumed;
+}
+
+void decimator::reset(size_t channels)
+{
+    _channels = channels;
+    _frames.assign((tap_count - 1) * channels, 0.0f);
+    _skip = 0;
+}
+
+void decimator::process(std::span<const float> in, std::vector<float>& out)
+{
+    static const auto taps = make_taps();
+    if (_channels == 0) {
+        return;
+    }
+    _frames.insert(_frames.end(), in.begin(), in.end());
+
+    // frame i is the newest one under the filter, the taps are symmetric
+    const size_t frames = _frames.size() / _channels;
+    size_t i = tap_count - 1 + _skip;
+    out.reserve(out.size() + (frames - i + 1) / 2 * _channels);
+    for (; i < frames; i += 2) {
+        const float* first = &_frames[(i + 1 - tap_count) * _channels];
+        for (size_t c = 0; c < _channels; ++c) {
+            float sum = 0;
+            for (size_t k = 0; k < tap_count; ++k) {
+                sum += taps[k] * first[k * _channels + c];
+            }
+            out.push_back(sum);
+        }
+    }
+
+    const size_t consumed = frames - (tap_count - 1);
+    _frames.erase(_frames.begin(), _frames.begin() + consumed * _channels);
+    _skip = i - frames;
+}
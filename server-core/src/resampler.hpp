@@ -0,0 +1,57 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Streaming resampler for ratios close to 1, interleaved float frames.
+// 4 points cubic Hermite interpolation: cheap, and transparent enough for the few hundred ppm of clock drift.
+// The ratio may change on every call without a click.
+class resampler {
+public:
+    void reset(size_t channels);
+
+    // append to `out` about in.size() * ratio samples, ratio is output frames per input frame
+    void process(std::span<const float> in, double ratio, std::vector<float>& out);
+
+private:
+    size_t _channels = 0;
+    std::vector<float> _frames; // the last 3 input frames, then the current input
+    double _phase = 0;          // position of the next output frame, in input frames from _frames[1]
+};
+
+// Halves the sample rate of interleaved float frames, behind a windowed sinc low pass.
+class decimator {
+public:
+    static constexpr size_t tap_count = 63;
+
+    void reset(size_t channels);
+
+    // append to `out` every other frame of the filtered input
+    void process(std::span<const float> in, std::vector<float>& out);
+
+private:
+    size_t _channels = 0;
+    std::vector<float> _frames; // the last tap_count - 1 input frames, then the current input
+    size_t _skip = 0;           // input frames to skip before the next output, 0 or 1
+};
+
+#endif // !RESAMPLER_HPP
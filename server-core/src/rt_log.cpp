@@ -0,0 +1,206 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "rt_log.hpp"
+
+#include <bit>
+#include <memory>
+#include <thread>
+
+#include <spdlog/async.h>
+#include <spdlog/async_logger.h>
+
+namespace rt_log {
+
+thread_local bool detail::g_realtime = false;
+
+namespace {
+
+    // bounded mpmc queue, every cell carries the position it expects next (D. Vyukov)
+    struct cell_t {
+        std::atomic<uint64_t> sequence;
+        detail::record_t record;
+    };
+
+    std::atomic<uint64_t> g_dropped;
+
+    // forward to the asynchronous logger, except the calls made within a realtime scope.
+    // spdlog formats before it gets here, so the server logs through rt_log::log() and this only keeps a stray
+    // direct call on a realtime thread from reaching the thread pool queue.
+    class guarded_logger : public spdlog::logger {
+    public:
+        explicit guarded_logger(std::shared_ptr<spdlog::async_logger> inner)
+            : spdlog::logger(inner->name())
+            , _inner(std::move(inner))
+        {
+        }
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override
+        {
+            if (in_realtime()) {
+                g_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            _inner->log(msg.time, msg.source, msg.level, msg.payload);
+        }
+
+        void flush_() override
+        {
+            _inner->flush();
+        }
+
+    private:
+        std::shared_ptr<spdlog::async_logger> _inner;
+    };
+
+    constexpr auto poll_interval = std::chrono::milliseconds(10);
+    constexpr size_t async_queue_size = 8192;
+
+    std::unique_ptr<cell_t[]> g_cells;
+    size_t g_mask = 0;
+    std::atomic<uint64_t> g_enqueue_position;
+    uint64_t g_dequeue_position = 0; // the consumer thread only
+    std::atomic_bool g_started;
+    std::atomic_bool g_stopped;
+    std::thread g_thread;
+    std::shared_ptr<spdlog::logger> g_sync_logger;
+
+    // format and forward everything queued, return false if the queue was empty
+    bool drain()
+    {
+        bool any = false;
+        spdlog::memory_buf_t buffer;
+        while (true) {
+            auto& cell = g_cells[g_dequeue_position & g_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != g_dequeue_position + 1) {
+                return any;
+            }
+            buffer.clear();
+            cell.record.format(cell.record, buffer);
+            spdlog::default_logger_raw()->log(cell.record.time, {}, cell.record.level, spdlog::string_view_t(buffer.data(), buffer.size()));
+            cell.sequence.store(g_dequeue_position + g_mask + 1, std::memory_order_release);
+            ++g_dequeue_position;
+            any = true;
+        }
+    }
+
+} // namespace
+
+detail::record_t* detail::acquire()
+{
+    if (!g_started.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    auto position = g_enqueue_position.load(std::memory_order_relaxed);
+    while (true) {
+        auto& cell = g_cells[position & g_mask];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (g_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &cell.record;
+            }
+        } else if (sequence < position) {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = g_enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool detail::started()
+{
+    return g_started.load(std::memory_order_acquire);
+}
+
+void detail::write(const record_t& record)
+{
+    spdlog::memory_buf_t buffer;
+    record.format(record, buffer);
+    spdlog::default_logger_raw()->log(record.time, {}, record.level, spdlog::string_view_t(buffer.data(), buffer.size()));
+}
+
+void detail::commit(record_t* record)
+{
+    // the record is the second member of its cell
+    auto cell = (cell_t*)((std::byte*)record - offsetof(cell_t, record));
+    cell->sequence.store(cell->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void start(size_t capacity)
+{
+    if (g_started) {
+        return;
+    }
+
+    capacity = std::bit_ceil(capacity < 2 ? 2 : capacity);
+    g_cells = std::make_unique<cell_t[]>(capacity);
+    g_mask = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i) {
+        g_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    g_enqueue_position = 0;
+    g_dequeue_position = 0;
+
+    // the same sinks, written by the spdlog thread, a full queue overwrites the oldest message instead of waiting
+    g_sync_logger = spdlog::default_logger();
+    // kept over restarts, the asynchronous loggers of the last run may still hold messages
+    if (!spdlog::thread_pool()) {
+        spdlog::init_thread_pool(async_queue_size, 1);
+    }
+    auto sinks = g_sync_logger->sinks();
+    auto async_logger = std::make_shared<spdlog::async_logger>(g_sync_logger->name(), sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    async_logger->set_level(spdlog::level::trace); // filtered by the guarded logger
+    async_logger->flush_on(g_sync_logger->flush_level());
+    auto logger = std::make_shared<guarded_logger>(std::move(async_logger));
+    logger->set_level(g_sync_logger->level());
+    spdlog::set_default_logger(logger);
+
+    g_stopped = false;
+    g_thread = std::thread([] {
+        while (!g_stopped) {
+            if (!drain()) {
+                std::this_thread::sleep_for(poll_interval);
+            }
+        }
+        drain();
+    });
+    g_started.store(true, std::memory_order_release);
+}
+
+void stop()
+{
+    if (!g_started) {
+        return;
+    }
+    g_started = false;
+    g_stopped = true;
+    g_thread.join();
+
+    // the messages still queued keep the asynchronous logger alive until they are written
+    spdlog::default_logger()->flush();
+    g_sync_logger->set_level(spdlog::default_logger()->level());
+    spdlog::set_default_logger(g_sync_logger);
+    g_sync_logger = nullptr;
+}
+
+uint64_t dropped()
+{
+    return g_dropped.load(std::memory_order_relaxed);
+}
+
+} // namespace rt_log
@@ -0,0 +1,240 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef RT_LOG_HPP
+#define RT_LOG_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <spdlog/spdlog.h>
+
+// Logging that never blocks the audio path, used by the whole server.
+// rt_log::log() copies its arguments into a preallocated lock-free queue, a background thread formats them later
+// and hands them to spdlog. Strings are copied into the record, truncated past max_text_size, the other arguments
+// are kept by value. Only numbers, enums, strings and the types marked by rt_log::is_value are accepted, anything else
+// has to be formatted into a string by the caller. A full queue drops the message. Before start() and after stop(),
+// messages are formatted right away.
+// start() also replaces the spdlog default logger by an asynchronous one, so the sinks are written by the spdlog
+// thread pool, and drops the direct spdlog calls made within a realtime_scope instead of queuing them.
+namespace rt_log {
+
+// other types that are self-contained and can be formatted later, specialized next to their formatter
+template <typename T>
+struct is_value : std::false_type { };
+
+namespace detail {
+
+    constexpr size_t max_args_size = 128;
+    constexpr size_t max_text_size = 384;
+
+    // a string argument, copied into the text of its record
+    struct text_t {
+        uint16_t offset;
+        uint16_t size;
+    };
+
+    struct record_t {
+        spdlog::level::level_enum level;
+        spdlog::log_clock::time_point time;
+        std::string_view format_string;
+        void (*format)(const record_t& record, spdlog::memory_buf_t& buffer);
+        alignas(std::max_align_t) std::array<std::byte, max_args_size> args;
+        std::array<char, max_text_size> text;
+        size_t text_size;
+    };
+
+    template <typename T>
+    constexpr bool is_text_v = std::is_convertible_v<const T&, std::string_view>;
+
+    template <typename T>
+    using stored_t = std::conditional_t<is_text_v<T>, text_t, T>;
+
+    template <typename T>
+    constexpr bool is_deferrable_v = is_text_v<T> || std::is_arithmetic_v<T> || std::is_enum_v<T> || is_value<T>::value;
+
+    template <typename T>
+    using loaded_t = std::conditional_t<std::is_same_v<T, text_t>, std::string_view, const T&>;
+
+    template <typename T>
+    stored_t<T> store(record_t& record, const T& arg)
+    {
+        if constexpr (is_text_v<T>) {
+            std::string_view text;
+            if constexpr (std::is_pointer_v<T>) {
+                text = arg ? std::string_view(arg) : std::string_view();
+            } else {
+                text = arg;
+            }
+            const size_t size = std::min(text.size(), max_text_size - record.text_size);
+            if (size) {
+                std::memcpy(record.text.data() + record.text_size, text.data(), size);
+            }
+            const text_t stored { (uint16_t)record.text_size, (uint16_t)size };
+            record.text_size += size;
+            return stored;
+        } else {
+            return arg;
+        }
+    }
+
+    template <typename T>
+    loaded_t<T> load(const record_t& record, const T& stored)
+    {
+        if constexpr (std::is_same_v<T, text_t>) {
+            return std::string_view(record.text.data() + stored.offset, stored.size);
+        } else {
+            return stored;
+        }
+    }
+
+    template <typename... Stored>
+    void format_record(const record_t& record, spdlog::memory_buf_t& buffer)
+    {
+        auto& args = *std::launder((const std::tuple<Stored...>*)record.args.data());
+        std::apply([&](const auto&... stored) {
+            std::tuple<loaded_t<Stored>...> loaded { load(record, stored)... };
+            std::apply([&](auto&... arg) {
+                fmt::vformat_to(std::back_inserter(buffer), record.format_string, fmt::make_format_args(arg...));
+            }, loaded);
+        }, args);
+    }
+
+    template <typename... Args>
+    void fill(record_t& record, spdlog::level::level_enum level, fmt::string_view format, const Args&... args)
+    {
+        record.level = level;
+        record.time = spdlog::log_clock::now();
+        record.format_string = std::string_view(format.data(), format.size());
+        record.format = &format_record<stored_t<Args>...>;
+        record.text_size = 0;
+        // braced, so the strings are copied in order
+        new (record.args.data()) std::tuple<stored_t<Args>...> { store(record, args)... };
+    }
+
+    // format and write a record that doesn't go through the queue
+    void write(const record_t& record);
+
+    // return nullptr when the queue is full or not started
+    record_t* acquire();
+    void commit(record_t* record);
+    bool started();
+
+    extern thread_local bool g_realtime;
+
+} // namespace detail
+
+inline bool in_realtime()
+{
+    return detail::g_realtime;
+}
+
+// queue `capacity` messages, rounded up to a power of two
+void start(size_t capacity = 1024);
+void stop();
+
+// messages lost to a full queue
+uint64_t dropped();
+
+template <typename... Args>
+void log(spdlog::level::level_enum level, fmt::format_string<Args...> format, const Args&... args)
+{
+    // formatted later, the arguments must not refer to anything, format views like fmt::join() into a string first
+    static_assert((detail::is_deferrable_v<Args> && ...), "only strings and plain values can be deferred");
+    static_assert(sizeof(std::tuple<detail::stored_t<Args>...>) <= detail::max_args_size, "too many arguments");
+
+    // before anything is formatted or copied
+    if (!spdlog::should_log(level)) {
+        return;
+    }
+    if (auto record = detail::acquire()) {
+        detail::fill(*record, level, format, args...);
+        detail::commit(record);
+    } else if (!detail::started() && !in_realtime()) {
+        detail::record_t record;
+        detail::fill(record, level, format, args...);
+        detail::write(record);
+    }
+}
+
+template <typename... Args>
+void trace(fmt::format_string<Args...> format, const Args&... args)
+{
+    log(spdlog::level::trace, format, args...);
+}
+
+template <typename... Args>
+void debug(fmt::format_string<Args...> format, const Args&... args)
+{
+    log(spdlog::level::debug, format, args...);
+}
+
+template <typename... Args>
+void info(fmt::format_string<Args...> format, const Args&... args)
+{
+    log(spdlog::level::info, format, args...);
+}
+
+template <typename... Args>
+void warn(fmt::format_string<Args...> format, const Args&... args)
+{
+    log(spdlog::level::warn, format, args...);
+}
+
+template <typename... Args>
+void error(fmt::format_string<Args...> format, const Args&... args)
+{
+    log(spdlog::level::err, format, args...);
+}
+
+template <typename... Args>
+void critical(fmt::format_string<Args...> format, const Args&... args)
+{
+    log(spdlog::level::critical, format, args...);
+}
+
+// spdlog calls made by the current thread within the scope are dropped
+class realtime_scope {
+public:
+    realtime_scope()
+        : _previous(detail::g_realtime)
+    {
+        detail::g_realtime = true;
+    }
+
+    ~realtime_scope()
+    {
+        detail::g_realtime = _previous;
+    }
+
+    realtime_scope(const realtime_scope&) = delete;
+    realtime_scope& operator=(const realtime_scope&) = delete;
+
+private:
+    bool _previous;
+};
+
+} // namespace rt_log
+
+#endif // !RT_LOG_HPP
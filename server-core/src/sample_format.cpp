@@ -0,0 +1,180 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "sample_format.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace io::github::mkckr0::audio_share_app::pb;
+
+namespace sample_format {
+
+namespace {
+
+    // every sample goes through a full scale int32
+    template <encoding_t E>
+    int32_t load(const uint8_t* p);
+
+    template <encoding_t E>
+    void store(uint8_t* p, int32_t v);
+
+    template <>
+    int32_t load<AudioFormat_Encoding_ENCODING_PCM_FLOAT>(const uint8_t* p)
+    {
+        float f;
+        std::memcpy(&f, p, sizeof(f));
+        f = std::clamp(f, -1.0f, 1.0f);
+        return (int32_t)std::clamp(f * 2147483648.0, -2147483648.0, 2147483647.0);
+    }
+
+    template <>
+    int32_t load<AudioFormat_Encoding_ENCODING_PCM_8BIT>(const uint8_t* p)
+    {
+        return (int32_t)((uint32_t)(p[0] ^ 0x80) << 24);
+    }
+
+    template <>
+    int32_t load<AudioFormat_Encoding_ENCODING_PCM_16BIT>(const uint8_t* p)
+    {
+        return (int32_t)((uint32_t)p[0] << 16 | (uint32_t)p[1] << 24);
+    }
+
+    template <>
+    int32_t load<AudioFormat_Encoding_ENCODING_PCM_24BIT>(const uint8_t* p)
+    {
+        return (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24);
+    }
+
+    template <>
+    int32_t load<AudioFormat_Encoding_ENCODING_PCM_32BIT>(const uint8_t* p)
+    {
+        int32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    template <>
+    void store<AudioFormat_Encoding_ENCODING_PCM_FLOAT>(uint8_t* p, int32_t v)
+    {
+        float f = (float)(v / 2147483648.0);
+        std::memcpy(p, &f, sizeof(f));
+    }
+
+    template <>
+    void store<AudioFormat_Encoding_ENCODING_PCM_8BIT>(uint8_t* p, int32_t v)
+    {
+        p[0] = (uint8_t)((uint32_t)v >> 24) ^ 0x80;
+    }
+
+    template <>
+    void store<AudioFormat_Encoding_ENCODING_PCM_16BIT>(uint8_t* p, int32_t v)
+    {
+        p[0] = (uint8_t)((uint32_t)v >> 16);
+        p[1] = (uint8_t)((uint32_t)v >> 24);
+    }
+
+    template <>
+    void store<AudioFormat_Encoding_ENCODING_PCM_24BIT>(uint8_t* p, int32_t v)
+    {
+        p[0] = (uint8_t)((uint32_t)v >> 8);
+        p[1] = (uint8_t)((uint32_t)v >> 16);
+        p[2] = (uint8_t)((uint32_t)v >> 24);
+    }
+
+    template <>
+    void store<AudioFormat_Encoding_ENCODING_PCM_32BIT>(uint8_t* p, int32_t v)
+    {
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    template <encoding_t From, encoding_t To>
+    void convert_samples(const uint8_t* src, uint8_t* dst, size_t samples)
+    {
+        constexpr int src_size = From == AudioFormat_Encoding_ENCODING_PCM_8BIT ? 1 : From == AudioFormat_Encoding_ENCODING_PCM_16BIT ? 2 : From == AudioFormat_Encoding_ENCODING_PCM_24BIT ? 3 : 4;
+        constexpr int dst_size = To == AudioFormat_Encoding_ENCODING_PCM_8BIT ? 1 : To == AudioFormat_Encoding_ENCODING_PCM_16BIT ? 2 : To == AudioFormat_Encoding_ENCODING_PCM_24BIT ? 3 : 4;
+        for (size_t i = 0; i < samples; ++i) {
+            store<To>(dst + i * dst_size, load<From>(src + i * src_size));
+        }
+    }
+
+    template <encoding_t From>
+    void convert_from(const uint8_t* src, uint8_t* dst, encoding_t to, size_t samples)
+    {
+        switch (to) {
+        case AudioFormat_Encoding_ENCODING_PCM_FLOAT:
+            return convert_samples<From, AudioFormat_Encoding_ENCODING_PCM_FLOAT>(src, dst, samples);
+        case AudioFormat_Encoding_ENCODING_PCM_8BIT:
+            return convert_samples<From, AudioFormat_Encoding_ENCODING_PCM_8BIT>(src, dst, samples);
+        case AudioFormat_Encoding_ENCODING_PCM_16BIT:
+            return convert_samples<From, AudioFormat_Encoding_ENCODING_PCM_16BIT>(src, dst, samples);
+        case AudioFormat_Encoding_ENCODING_PCM_24BIT:
+            return convert_samples<From, AudioFormat_Encoding_ENCODING_PCM_24BIT>(src, dst, samples);
+        case AudioFormat_Encoding_ENCODING_PCM_32BIT:
+            return convert_samples<From, AudioFormat_Encoding_ENCODING_PCM_32BIT>(src, dst, samples);
+        default:
+            break;
+        }
+    }
+
+} // namespace
+
+int bytes_per_sample(encoding_t encoding)
+{
+    switch (encoding) {
+    case AudioFormat_Encoding_ENCODING_PCM_FLOAT:
+        return 4;
+    case AudioFormat_Encoding_ENCODING_PCM_8BIT:
+        return 1;
+    case AudioFormat_Encoding_ENCODING_PCM_16BIT:
+        return 2;
+    case AudioFormat_Encoding_ENCODING_PCM_24BIT:
+        return 3;
+    case AudioFormat_Encoding_ENCODING_PCM_32BIT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+void convert(const void* src, encoding_t from, void* dst, encoding_t to, size_t samples)
+{
+    auto s = (const uint8_t*)src;
+    auto d = (uint8_t*)dst;
+
+    if (from == to) {
+        std::memcpy(d, s, samples * bytes_per_sample(from));
+        return;
+    }
+
+    switch (from) {
+    case AudioFormat_Encoding_ENCODING_PCM_FLOAT:
+        return convert_from<AudioFormat_Encoding_ENCODING_PCM_FLOAT>(s, d, to, samples);
+    case AudioFormat_Encoding_ENCODING_PCM_8BIT:
+        return convert_from<AudioFormat_Encoding_ENCODING_PCM_8BIT>(s, d, to, samples);
+    case AudioFormat_Encoding_ENCODING_PCM_16BIT:
+        return convert_from<AudioFormat_Encoding_ENCODING_PCM_16BIT>(s, d, to, samples);
+    case AudioFormat_Encoding_ENCODING_PCM_24BIT:
+        return convert_from<AudioFormat_Encoding_ENCODING_PCM_24BIT>(s, d, to, samples);
+    case AudioFormat_Encoding_ENCODING_PCM_32BIT:
+        return convert_from<AudioFormat_Encoding_ENCODING_PCM_32BIT>(s, d, to, samples);
+    default:
+        break;
+    }
+}
+
+} // namespace sample_format
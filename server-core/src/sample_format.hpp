@@ -0,0 +1,38 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SAMPLE_FORMAT_HPP
+#define SAMPLE_FORMAT_HPP
+
+#include <cstddef>
+
+#include "client.pb.h"
+
+// PCM sample conversion between the AudioFormat encodings.
+// All encodings are little endian and interleaved, 8 bit is unsigned like Android's ENCODING_PCM_8BIT.
+namespace sample_format {
+
+using encoding_t = io::github::mkckr0::audio_share_app::pb::AudioFormat_Encoding;
+
+// 0 for ENCODING_INVALID
+int bytes_per_sample(encoding_t encoding);
+
+// `dst` must hold `samples * bytes_per_sample(to)` bytes
+void convert(const void* src, encoding_t from, void* dst, encoding_t to, size_t samples);
+
+} // namespace sample_format
+
+#endif // !SAMPLE_FORMAT_HPP
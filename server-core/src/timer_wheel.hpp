@@ -0,0 +1,117 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel driven by an external tick.
+// Level n has 2^SlotBits slots, each one spanning 2^(SlotBits*n) ticks. When the wheel
+// reaches a slot of an upper level, its timers are cascaded down to the lower levels.
+// Scheduling is O(1). There is no cancel: the owner drops stale values when they expire.
+template <typename T, size_t Levels = 4, size_t SlotBits = 6>
+class timer_wheel {
+public:
+    using tick_t = uint64_t;
+
+    static constexpr size_t slot_count = size_t(1) << SlotBits;
+    static constexpr tick_t max_delay = (tick_t(1) << (SlotBits * Levels)) - 1;
+
+    // expire after `delay` ticks, at least one
+    void schedule(T value, tick_t delay)
+    {
+        delay = std::clamp<tick_t>(delay, 1, max_delay);
+        insert({ _now + delay, std::move(value) });
+        ++_size;
+    }
+
+    // move the wheel one tick forward and call `fn(value)` for every expired timer
+    template <typename Fn>
+    void advance(Fn&& fn)
+    {
+        ++_now;
+
+        for (size_t level = 1; level < Levels; ++level) {
+            if (_now & ((tick_t(1) << (SlotBits * level)) - 1)) {
+                break;
+            }
+            auto& bucket = _levels[level][slot_index(_now, level)];
+            _cascade.swap(bucket);
+            for (auto& entry : _cascade) {
+                insert(std::move(entry));
+            }
+            _cascade.clear();
+        }
+
+        auto& bucket = _levels[0][slot_index(_now, 0)];
+        if (bucket.empty()) {
+            return;
+        }
+        _expired.swap(bucket);
+        _size -= _expired.size();
+        for (auto& entry : _expired) {
+            fn(entry.value);
+        }
+        _expired.clear();
+    }
+
+    void clear()
+    {
+        for (auto& level : _levels) {
+            for (auto& bucket : level) {
+                bucket.clear();
+            }
+        }
+        _size = 0;
+    }
+
+    tick_t now() const { return _now; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    struct entry_t {
+        tick_t deadline;
+        T value;
+    };
+
+    static size_t slot_index(tick_t tick, size_t level)
+    {
+        return (size_t)(tick >> (SlotBits * level)) & (slot_count - 1);
+    }
+
+    void insert(entry_t entry)
+    {
+        const tick_t delta = entry.deadline - _now;
+        size_t level = 0;
+        while (level + 1 < Levels && delta >= (tick_t(1) << (SlotBits * (level + 1)))) {
+            ++level;
+        }
+        _levels[level][slot_index(entry.deadline, level)].push_back(std::move(entry));
+    }
+
+    std::array<std::array<std::vector<entry_t>, slot_count>, Levels> _levels;
+    std::vector<entry_t> _cascade;
+    std::vector<entry_t> _expired;
+    tick_t _now = 0;
+    size_t _size = 0;
+};
+
+#endif // !TIMER_WHEEL_HPP
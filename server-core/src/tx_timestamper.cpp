@@ -0,0 +1,192 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "tx_timestamper.hpp"
+#include "rt_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WINDOWS
+#include <cerrno>
+#include <ctime>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif // !_WINDOWS
+
+tx_timestamper::mode_t tx_timestamper::parse_mode(std::string_view mode)
+{
+    if (mode == "off") {
+        return mode_off;
+    }
+    if (mode == "software") {
+        return mode_software;
+    }
+    if (mode == "hardware") {
+        return mode_hardware;
+    }
+    throw std::invalid_argument("invalid tx timestamp mode: " + std::string(mode));
+}
+
+bool tx_timestamper::enable(asio::ip::udp::socket::native_handle_type socket, mode_t mode)
+{
+    reset();
+    if (mode == mode_off) {
+        return true;
+    }
+#ifdef SO_TIMESTAMPING
+    // TSONLY: the stamps come back without a copy of the datagram
+    unsigned flags = SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    if (mode == mode_hardware) {
+        flags |= SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    } else {
+        flags |= SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    }
+    if (::setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags))) {
+        rt_log::warn("{} {}", __func__, std::strerror(errno));
+        return false;
+    }
+    // enabling OPT_ID restarts the numbering of the sends from 0
+    _mode = mode;
+    rt_log::info("tx timestamps {}", mode == mode_hardware ? "hardware" : "software");
+    return true;
+#else
+    rt_log::warn("tx timestamps are not supported on this platform");
+    return false;
+#endif // SO_TIMESTAMPING
+}
+
+void tx_timestamper::reset()
+{
+    _mode = mode_off;
+    _pending.clear();
+    _next_ticket = 0;
+    _next_key = 0;
+    _lost = 0;
+}
+
+uint64_t tx_timestamper::sent(int peer)
+{
+    const uint64_t ticket = _next_ticket++;
+    if (_mode == mode_off) {
+        return ticket;
+    }
+    if (_pending.size() >= _max_pending) {
+        _pending.pop_front();
+        ++_lost;
+    }
+    int64_t time_ns = 0;
+#ifndef _WINDOWS
+    timespec now;
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    time_ns = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif // !_WINDOWS
+    _pending.push_back({ ticket, _next_key++, peer, time_ns });
+    return ticket;
+}
+
+void tx_timestamper::failed(uint64_t ticket)
+{
+    if (_mode == mode_off) {
+        return;
+    }
+    // the kernel numbers only the sends which went through, the later ones shift down
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        if (it->ticket == ticket) {
+            it = _pending.erase(it);
+            continue;
+        }
+        if (it->ticket > ticket) {
+            --it->key;
+        }
+        ++it;
+    }
+    --_next_key;
+}
+
+void tx_timestamper::match(uint32_t key, int64_t time_ns, std::vector<sample_t>& samples)
+{
+    // the stamps come back in send order, the skipped ones are lost
+    while (!_pending.empty() && (int32_t)(_pending.front().key - key) < 0) {
+        _pending.pop_front();
+        ++_lost;
+    }
+    if (_pending.empty() || _pending.front().key != key) {
+        return;
+    }
+    const auto& pending = _pending.front();
+    samples.push_back({ pending.peer, std::chrono::nanoseconds(std::max<int64_t>(time_ns - pending.time_ns, 0)) });
+    _pending.pop_front();
+}
+
+bool tx_timestamper::drain(asio::ip::udp::socket::native_handle_type socket, std::vector<sample_t>& samples)
+{
+    if (_mode == mode_off) {
+        return true;
+    }
+#ifdef SO_TIMESTAMPING
+    while (true) {
+        std::array<char, 512> control;
+        char data;
+        iovec iov { &data, sizeof(data) };
+        msghdr msg {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        if (::recvmsg(socket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            rt_log::warn("{} {}", __func__, std::strerror(errno));
+            return false;
+        }
+
+        bool has_key = false;
+        uint32_t key = 0;
+        int64_t time_ns = 0;
+        for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                scm_timestamping stamps;
+                std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                const auto& ts = stamps.ts[_mode == mode_hardware ? 2 : 0];
+                time_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+            } else if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                sock_extended_err err;
+                std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+                if (err.ee_errno == ENOMSG && err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING && err.ee_info == SCM_TSTAMP_SND) {
+                    has_key = true;
+                    key = err.ee_data;
+                }
+            }
+        }
+        if (has_key && time_ns) {
+            match(key, time_ns, samples);
+        }
+    }
+#else
+    return false;
+#endif // SO_TIMESTAMPING
+}
@@ -0,0 +1,83 @@
+/*
+   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef TX_TIMESTAMPER_HPP
+#define TX_TIMESTAMPER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+#include "pre_asio.hpp"
+#include <asio.hpp>
+
+// Kernel transmit timestamps of a udp socket (SO_TIMESTAMPING), Linux only.
+// The kernel numbers the sends of the socket (SOF_TIMESTAMPING_OPT_ID) and reports when each datagram left the
+// driver, or the NIC for the hardware mode, on the socket error queue. Matched with the time of the send call,
+// it gives how long the datagram sat in the qdisc and the driver. Everything runs on the network thread.
+class tx_timestamper {
+public:
+    enum mode_t : uint8_t {
+        mode_off,
+        mode_software,
+        mode_hardware, // the interface must have hardware stamping enabled, and its clock synced to the system clock
+    };
+
+    struct sample_t {
+        int peer;
+        std::chrono::nanoseconds delay; // send call to the wire
+    };
+
+    // "off", "software" or "hardware", throw std::invalid_argument otherwise
+    static mode_t parse_mode(std::string_view mode);
+
+    bool enable(asio::ip::udp::socket::native_handle_type socket, mode_t mode);
+    bool enabled() const { return _mode != mode_off; }
+    void reset();
+
+    // call right before every send of the socket, even those of no peer, return the ticket of failed()
+    uint64_t sent(int peer);
+
+    // the send of `ticket` failed, so the kernel didn't number it
+    void failed(uint64_t ticket);
+
+    // read the error queue without blocking, append the matched sends to `samples`, return false on error
+    bool drain(asio::ip::udp::socket::native_handle_type socket, std::vector<sample_t>& samples);
+
+    // sends whose timestamp never came back
+    uint64_t lost() const { return _lost; }
+
+private:
+    struct pending_t {
+        uint64_t ticket;
+        uint32_t key;   // expected kernel number
+        int peer;
+        int64_t time_ns; // CLOCK_REALTIME, the clock of the kernel stamps
+    };
+
+    void match(uint32_t key, int64_t time_ns, std::vector<sample_t>& samples);
+
+    mode_t _mode = mode_off;
+    std::deque<pending_t> _pending;
+    uint64_t _next_ticket = 0;
+    uint32_t _next_key = 0;
+    uint64_t _lost = 0;
+    constexpr static size_t _max_pending = 4096; // the driver may not stamp at all
+};
+
+#endif // !TX_TIMESTAMPER_HPP
@@ -0,0 +1,92 @@
+#   Copyright 2022-2024 mkckr0 <https://github.com/mkckr0>
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+
+"""Convert a flight recorder dump to a Chrome trace, to open in chrome://tracing or ui.perfetto.dev.
+
+usage: python3 flight_recorder.py flight-<time>-<reason>.bin [-o trace.json]
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+HEADER = struct.Struct("<4sIQQII")
+EVENT = struct.Struct("<QIIQ")
+
+REASONS = ["signal", "send-gap", "overrun", "xrun"]
+
+CAPTURE_THREAD = 1
+NETWORK_THREAD = 2
+
+# type: (name, thread, args from a and b)
+EVENTS = {
+    1: ("capture", CAPTURE_THREAD, lambda a, b: {"bytes": a, "frames": b}),
+    2: ("fanout", NETWORK_THREAD, lambda a, b: {"packets": a}),
+    3: ("send", NETWORK_THREAD, lambda a, b: {"id": a, "bytes": b}),
+    4: ("send error", NETWORK_THREAD, lambda a, b: {"id": a, "error": b}),
+    5: ("drop", NETWORK_THREAD, lambda a, b: {"id": a, "in_flight": b}),
+    6: ("format changed", NETWORK_THREAD, lambda a, b: {"version": a, "sample_rate": b}),
+    7: ("timeout", NETWORK_THREAD, lambda a, b: {"id": a}),
+    8: ("xrun", CAPTURE_THREAD, lambda a, b: {}),
+    9: ("send gap", NETWORK_THREAD, lambda a, b: {"gap_us": a, "quantum_us": b}),
+    10: ("trigger", NETWORK_THREAD, lambda a, b: {"reason": REASONS[a] if a < len(REASONS) else a}),
+}
+
+
+def decode(data):
+    magic, version, count, dump_time, reason, _ = HEADER.unpack_from(data)
+    if magic != b"ASFR" or version != 1:
+        raise ValueError("not a flight recorder dump")
+
+    trace = []
+    for pid, tid, name in [(1, CAPTURE_THREAD, "capture"), (1, NETWORK_THREAD, "network")]:
+        trace.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": tid, "args": {"name": name}})
+
+    events = [EVENT.unpack_from(data, HEADER.size + i * EVENT.size) for i in range(count)]
+    base = min((e[0] for e in events), default=dump_time)
+    for time_ns, type, a, b in events:
+        name, tid, args = EVENTS.get(type, (f"event {type}", NETWORK_THREAD, lambda a, b: {"a": a, "b": b}))
+        if type == 10 and a == 3:
+            tid = CAPTURE_THREAD  # an xrun is triggered by the capture thread
+        # relative to the oldest event, in us
+        ts = (time_ns - base) / 1000
+        if type == 2:
+            # b is the duration, the event ends at its timestamp
+            trace.append({"name": name, "ph": "X", "ts": ts - b / 1000, "dur": b / 1000, "pid": 1, "tid": tid, "args": args(a, b)})
+        else:
+            trace.append({"name": name, "ph": "i", "s": "t", "ts": ts, "pid": 1, "tid": tid, "args": args(a, b)})
+
+    reason_name = REASONS[reason] if reason < len(REASONS) else str(reason)
+    return {"traceEvents": trace, "otherData": {"reason": reason_name, "events": count, "dump_us": (dump_time - base) / 1000}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump")
+    parser.add_argument("-o", "--output", help="default: stdout")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        trace = decode(f.read())
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,5 @@
-#pragma once
-
-#define WM_APP_NOTIFYICON (WM_APP + 1)
-
+#pragma once
+
+#define WM_APP_NOTIFYICON (WM_APP + 1)
+
 #define TIMER_ID_CHECK_UPDATE 1
\ No newline at end of file
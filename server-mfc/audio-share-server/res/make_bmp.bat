@@ -1 +1 @@
-magick ../../../android-app/app/src/main/ic_launcher-playstore.png -define bmp:format=bmp3 -define bmp3:alpha=false AudioShareServer.bmp
+magick ../../../android-app/app/src/main/ic_launcher-playstore.png -define bmp:format=bmp3 -define bmp3:alpha=false AudioShareServer.bmp
@@ -1,2 +1,2 @@
-magick ../../../android-app/app/src/main/ic_launcher-playstore.png -define icon:auto-resize=256,128,64,48,32 AudioShareServer.ico
+magick ../../../android-app/app/src/main/ic_launcher-playstore.png -define icon:auto-resize=256,128,64,48,32 AudioShareServer.ico
 pause
\ No newline at end of file
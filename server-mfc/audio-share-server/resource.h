@@ -1,61 +1,61 @@
-//{{NO_DEPENDENCIES}}
-// Microsoft Visual C++ generated include file.
-// Used by AudioShareServer.rc
-//
-#define IDM_ABOUTBOX                    0x0010
-#define IDD_ABOUTBOX                    100
-#define IDD_MAIN                        101
-#define IDD_SERVER                      102
-#define IDD_APP_SETTINGS                103
-#define IDS_START_SERVER                110
-#define IDS_ABOUTBOX                    111
-#define IDS_STOP_SERVER                 112
-#define IDS_SERVER                      113
-#define IDS_APP_SETTINGS                114
-#define IDS_DEFAULT                     115
-#define IDS_NO_ENDPOINT                 116
-#define IDS_NO_SELECTED_ENDPOINT        117
-#define IDS_ENGLISH                     118
-#define IDS_SIMPLIFIED_CHINESE          119
-#define IDS_SUCCESS                     120
-#define IDS_NO_UPDATE                   121
-#define IDS_NEW_VERSION                 122
-#define IDR_MAINFRAME                   128
-#define IDR_MENU_SYSTEM_TRAY            129
-#define IDB_BITMAP_APP                  130
-#define IDC_MFCLINK1                    1000
-#define IDC_TAB                         1001
-#define IDC_EDIT_PORT                   1100
-#define IDC_COMBO_AUDIO_ENDPOINT        1101
-#define IDC_COMBO_HOST                  1102
-#define IDC_BUTTON_SERVER               1103
-#define IDC_BUTTON_RESET                1104
-#define IDC_COMBO_ENCODING              1105
-#define IDC_BUTTON_SOUND_PANEL          1106
-#define IDC_CHECK_AUTORUN               1200
-#define IDC_BUTTON_REPPAIR_FIREWALL     1201
-#define IDC_RADIO_NONE                  1202
-#define IDC_RADIO_START                 1203
-#define IDC_RADIO_KEEP                  1204
-#define IDC_RADIO_EXIT                  1205
-#define IDC_RADIO_MINIMIZE              1206
-#define IDC_BUTTON_UPDATE               1207
-#define IDC_CHECK_AUTO_UPDATE           1208
-#define IDC_BUTTON_HIDE                 1209
-#define IDC_STATIC_VERSION              1213
-#define IDC_STATIC_COPYRIGHT            1214
-#define IDC_STATIC_NAME                 1215
-#define IDC_COMBO_LANGUAGE              1216
-#define ID_APP_SHOW                     32771
-#define ID_START_SERVER                 32772
-
-// Next default values for new objects
-// 
-#ifdef APSTUDIO_INVOKED
-#ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        131
-#define _APS_NEXT_COMMAND_VALUE         32773
-#define _APS_NEXT_CONTROL_VALUE         1218
-#define _APS_NEXT_SYMED_VALUE           107
-#endif
-#endif
+//{{NO_DEPENDENCIES}}
+// Microsoft Visual C++ generated include file.
+// Used by AudioShareServer.rc
+//
+#define IDM_ABOUTBOX                    0x0010
+#define IDD_ABOUTBOX                    100
+#define IDD_MAIN                        101
+#define IDD_SERVER                      102
+#define IDD_APP_SETTINGS                103
+#define IDS_START_SERVER                110
+#define IDS_ABOUTBOX                    111
+#define IDS_STOP_SERVER                 112
+#define IDS_SERVER                      113
+#define IDS_APP_SETTINGS                114
+#define IDS_DEFAULT                     115
+#define IDS_NO_ENDPOINT                 116
+#define IDS_NO_SELECTED_ENDPOINT        117
+#define IDS_ENGLISH                     118
+#define IDS_SIMPLIFIED_CHINESE          119
+#define IDS_SUCCESS                     120
+#define IDS_NO_UPDATE                   121
+#define IDS_NEW_VERSION                 122
+#define IDR_MAINFRAME                   128
+#define IDR_MENU_SYSTEM_TRAY            129
+#define IDB_BITMAP_APP                  130
+#define IDC_MFCLINK1                    1000
+#define IDC_TAB                         1001
+#define IDC_EDIT_PORT                   1100
+#define IDC_COMBO_AUDIO_ENDPOINT        1101
+#define IDC_COMBO_HOST                  1102
+#define IDC_BUTTON_SERVER               1103
+#define IDC_BUTTON_RESET                1104
+#define IDC_COMBO_ENCODING              1105
+#define IDC_BUTTON_SOUND_PANEL          1106
+#define IDC_CHECK_AUTORUN               1200
+#define IDC_BUTTON_REPPAIR_FIREWALL     1201
+#define IDC_RADIO_NONE                  1202
+#define IDC_RADIO_START                 1203
+#define IDC_RADIO_KEEP                  1204
+#define IDC_RADIO_EXIT                  1205
+#define IDC_RADIO_MINIMIZE              1206
+#define IDC_BUTTON_UPDATE               1207
+#define IDC_CHECK_AUTO_UPDATE           1208
+#define IDC_BUTTON_HIDE                 1209
+#define IDC_STATIC_VERSION              1213
+#define IDC_STATIC_COPYRIGHT            1214
+#define IDC_STATIC_NAME                 1215
+#define IDC_COMBO_LANGUAGE              1216
+#define ID_APP_SHOW                     32771
+#define ID_START_SERVER                 32772
+
+// Next default values for new objects
+// 
+#ifdef APSTUDIO_INVOKED
+#ifndef APSTUDIO_READONLY_SYMBOLS
+#define _APS_NEXT_RESOURCE_VALUE        131
+#define _APS_NEXT_COMMAND_VALUE         32773
+#define _APS_NEXT_CONTROL_VALUE         1218
+#define _APS_NEXT_SYMED_VALUE           107
+#endif
+#endif